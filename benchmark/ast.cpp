@@ -0,0 +1,123 @@
+// Allocation counts and teardown time of the arena-backed ASTContext
+// compared to allocating every node separately on the heap, which is
+// what the ASTContext used to do.
+//
+// Usage: bench_ast [MEGABYTES]
+
+#include <cstdlib>
+#include <new>
+#include <sstream>
+#include <variant>
+#include <vector>
+
+#include "benchmark/bench_support.h"
+#include "include/parser.h"
+
+namespace
+{
+std::size_t allocations = 0;
+
+// Replica of the heap-allocated AST.
+struct HeapSequence
+{
+    std::vector<Node> nodes;
+};
+
+using HeapNode = std::variant<const Init*, const Translation*, const Rotation*,
+                              const HeapSequence*, const Branch*, const Loop*>;
+
+struct HeapAST
+{
+    std::vector<HeapNode> owned;
+
+    ~HeapAST()
+    {
+        for (auto node : owned)
+            std::visit([](const auto* p) { delete p; }, node);
+    }
+
+    void clone(Node n)
+    {
+        std::visit([this](const auto* p) { cloneNode(p); }, n);
+    }
+
+    template<typename T>
+    void cloneNode(const T* node)
+    {
+        if constexpr (std::is_same_v<T, Sequence>)
+        {
+            for (auto child : node->nodes)
+                clone(child);
+            owned.push_back(new HeapSequence{std::vector<Node>(node->nodes.begin(), node->nodes.end())});
+        }
+        else
+        {
+            if constexpr (std::is_same_v<T, Branch>)
+            {
+                clone(node->lhs);
+                clone(node->rhs);
+            }
+            if constexpr (std::is_same_v<T, Loop>)
+                clone(node->body);
+            owned.push_back(new T(*node));
+        }
+    }
+};
+} // anonymous
+
+// GCC cannot tell that these replace the global allocation functions and
+// warns about freeing memory from operator new.
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+void* operator new(std::size_t size)
+{
+    ++allocations;
+    if (void* p = std::malloc(size))
+        return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
+int main(int argc, const char* argv[])
+{
+    const std::size_t megabytes = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 16;
+    std::string source = generateProgram(megabytes << 20);
+    std::stringstream diagOutput;
+    DiagnosticEmitter emitter(diagOutput, diagOutput);
+
+    Lexer lexer(std::string_view(source), emitter);
+    Parser parser(lexer, emitter);
+    std::size_t before = allocations;
+    Timer parseTimer;
+    auto context = parser.parse();
+    double parseMs = parseTimer.elapsedMs();
+    if (!context)
+    {
+        fmt::print(stderr, "Parsing failed: {}\n", diagOutput.str());
+        return EXIT_FAILURE;
+    }
+    fmt::print("Input: {} MB, nodes: {}\n", megabytes, context->getNodeCount());
+    fmt::print("arena: parse: {:8.2f} ms, allocations during parsing: {}\n", parseMs, allocations - before);
+
+    {
+        auto heap = std::make_unique<HeapAST>();
+        before = allocations;
+        heap->clone(context->getRoot());
+        fmt::print("heap:  allocations for the nodes: {}\n", allocations - before);
+        Timer teardownTimer;
+        heap.reset();
+        fmt::print("heap:  teardown: {:8.2f} ms\n", teardownTimer.elapsedMs());
+    }
+
+    Timer teardownTimer;
+    context.reset();
+    fmt::print("arena: teardown: {:8.2f} ms\n", teardownTimer.elapsedMs());
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,144 @@
+#ifndef BENCH_SUPPORT_H
+#define BENCH_SUPPORT_H
+
+#include <chrono>
+#include <cstddef>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <sys/resource.h>
+
+#include <fmt/format.h>
+
+// Generates a syntactically valid program of roughly `approxBytes` size.
+// The shape resembles machine generated inputs: lots of whitespace and
+// comments, with loops and branches nested up to `maxDepth` deep.
+inline std::string generateProgram(std::size_t approxBytes, int maxDepth = 4, unsigned seed = 42)
+{
+    std::mt19937 gen(seed);
+    std::uniform_int_distribution<int> pick(0, 9);
+    std::uniform_int_distribution<int> num(-500, 500);
+
+    std::string out = "init(50, 50, 50, 50)";
+    out.reserve(approxBytes + 1024);
+    int depth = 0;
+    std::string indent;
+    auto command = [&] {
+        switch (pick(gen))
+        {
+        case 0:
+            out += fmt::format("rotation({}, {}, {})", num(gen), num(gen), num(gen));
+            break;
+        case 1:
+            out += fmt::format("// translation({}, {})\n{}", num(gen), num(gen), indent);
+            [[fallthrough]];
+        default:
+            out += fmt::format("translation({}, {})", num(gen), num(gen));
+            break;
+        }
+    };
+    while (true)
+    {
+        const bool needMore = out.size() < approxBytes;
+        if (depth > 0 && (!needMore || pick(gen) == 0))
+        {
+            indent.resize(indent.size() - 2);
+            out += "\n" + indent + "}";
+            --depth;
+            continue;
+        }
+        if (!needMore)
+            break;
+
+        out += ";\n" + indent;
+        int choice = pick(gen);
+        if (depth < maxDepth && choice == 0)
+        {
+            out += "iter {\n";
+            ++depth;
+            indent += "  ";
+            out += indent;
+            command();
+        }
+        else if (depth < maxDepth && choice == 1)
+        {
+            out += "/* alternatives */ {\n" + indent + "  ";
+            command();
+            out += "\n" + indent + "} or {\n" + indent + "  ";
+            command();
+            out += "\n" + indent + "}";
+        }
+        else
+            command();
+    }
+    return out;
+}
+
+// Generates a loop around `arms` alternatives of `armLength` commands each,
+// the alternatives are nested as a balanced tree of "or"s. The arms are
+// independent of each other, every arm is a single block of the CFG.
+inline std::string generateWideProgram(int arms, int armLength, unsigned seed = 42)
+{
+    std::mt19937 gen(seed);
+    std::uniform_int_distribution<int> num(-500, 500);
+    std::string out = "init(50, 50, 50, 50);\niter {\n";
+    // The numbers of arms to generate, Or and End stand for the text between
+    // and after the operands of an "or".
+    constexpr int Or = -1;
+    constexpr int End = 0;
+    std::vector<int> pending{arms};
+    while (!pending.empty())
+    {
+        const int count = pending.back();
+        pending.pop_back();
+        if (count == Or || count == End)
+        {
+            out += count == Or ? "\n} or {\n" : "\n}";
+            continue;
+        }
+        if (count > 1)
+        {
+            out += "{\n";
+            pending.insert(pending.end(), {End, count - count / 2, Or, count / 2});
+            continue;
+        }
+        for (int i = 0; i < armLength; ++i)
+        {
+            if (i > 0)
+                out += ";\n";
+            if (i % 4 == 3)
+                out += fmt::format("rotation({}, {}, {})", num(gen), num(gen), num(gen));
+            else
+                out += fmt::format("translation({}, {})", num(gen), num(gen));
+        }
+    }
+    out += "\n}";
+    return out;
+}
+
+// Wall clock timer reporting milliseconds.
+class Timer
+{
+public:
+    Timer() : start(std::chrono::steady_clock::now()) {}
+
+    double elapsedMs() const
+    {
+        std::chrono::duration<double, std::milli> d = std::chrono::steady_clock::now() - start;
+        return d.count();
+    }
+
+private:
+    std::chrono::steady_clock::time_point start;
+};
+
+// Peak resident set size of the current process in kilobytes.
+inline long peakRssKb()
+{
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+}
+
+#endif // BENCH_SUPPORT_H
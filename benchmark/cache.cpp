@@ -0,0 +1,66 @@
+// Time to get the AST and the CFG of a program by lexing, parsing and
+// building the CFG, compared to loading them from a cache file.
+//
+// Usage: bench_cache [MEGABYTES]
+
+#include <cstdlib>
+#include <filesystem>
+#include <sstream>
+
+#include "benchmark/bench_support.h"
+#include "include/cache.h"
+#include "include/parser.h"
+
+int main(int argc, const char* argv[])
+{
+    const std::size_t megabytes = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 16;
+    std::string source = generateProgram(megabytes << 20);
+    std::stringstream diagOutput;
+    DiagnosticEmitter emitter(diagOutput, diagOutput);
+
+    double parseMs = 1e300;
+    std::optional<ASTContext> context;
+    for (int run = 0; run < 3; ++run)
+    {
+        Timer timer;
+        Lexer lexer(std::string_view(source), emitter);
+        Parser parser(lexer, emitter);
+        context = parser.parse();
+        if (!context)
+        {
+            fmt::print(stderr, "Parsing failed: {}\n", diagOutput.str());
+            return EXIT_FAILURE;
+        }
+        auto cfg = CFG::createCfg(context->getRoot());
+        parseMs = std::min(parseMs, timer.elapsedMs());
+    }
+
+    auto ast = FlatAST::flatten(std::move(*context));
+    auto cfg = CFG::createCfg(ast);
+    auto path = std::filesystem::temp_directory_path() / "bench_cache.dcache";
+    if (!ProgramCache::write(path.string(), ast, cfg))
+    {
+        fmt::print(stderr, "Unable to write '{}'.\n", path.string());
+        return EXIT_FAILURE;
+    }
+
+    double loadMs = 1e300;
+    for (int run = 0; run < 3; ++run)
+    {
+        Timer timer;
+        auto loaded = ProgramCache::load(path.string());
+        if (!loaded)
+        {
+            fmt::print(stderr, "Loading failed.\n");
+            return EXIT_FAILURE;
+        }
+        loadMs = std::min(loadMs, timer.elapsedMs());
+    }
+
+    fmt::print("Input: {} MB, nodes: {}, blocks: {}, cache: {:.2f} MB\n", megabytes, ast.getNodeCount(),
+               cfg.blocks().size(), std::filesystem::file_size(path) / 1e6);
+    fmt::print("lex + parse + cfg: {:8.2f} ms\n", parseMs);
+    fmt::print("load cache:        {:8.2f} ms ({:.1f}x)\n", loadMs, parseMs / loadMs);
+    std::filesystem::remove(path);
+    return EXIT_SUCCESS;
+}
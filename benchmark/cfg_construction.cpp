@@ -0,0 +1,131 @@
+// Time and peak heap usage of building the CFG of programs of different
+// shapes: the generated programs, wide branch fans (right-nested chains of
+// alternatives) and deep loop nests. Both should grow linearly with the
+// size of the program.
+//
+// Usage: bench_cfg_construction [MEGABYTES]
+
+#include <algorithm>
+#include <cstdlib>
+#include <new>
+#include <sstream>
+
+#include "benchmark/bench_support.h"
+#include "include/cfg.h"
+#include "include/parser.h"
+
+namespace
+{
+// The live and the peak bytes allocated through the global operator new.
+std::size_t liveBytes = 0;
+std::size_t peakBytes = 0;
+
+// Every allocation is prefixed with its size.
+constexpr std::size_t HeaderSize = alignof(std::max_align_t);
+} // anonymous
+
+void* operator new(std::size_t size)
+{
+    auto* block = static_cast<char*>(std::malloc(size + HeaderSize));
+    if (!block)
+        throw std::bad_alloc();
+    *reinterpret_cast<std::size_t*>(block) = size;
+    liveBytes += size;
+    peakBytes = std::max(peakBytes, liveBytes);
+    return block + HeaderSize;
+}
+
+void operator delete(void* ptr) noexcept
+{
+    if (!ptr)
+        return;
+    auto* block = static_cast<char*>(ptr) - HeaderSize;
+    liveBytes -= *reinterpret_cast<std::size_t*>(block);
+    std::free(block);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept
+{
+    operator delete(ptr);
+}
+
+namespace
+{
+// Alternatives nested `width` deep in the right-hand sides, repeated.
+std::string generateFans(std::size_t approxBytes, int width)
+{
+    std::string out = "init(50, 50, 50, 50)";
+    while (out.size() < approxBytes)
+    {
+        out += ";\n";
+        for (int i = 1; i < width; ++i)
+            out += "{ translation(1, 0) } or {\n";
+        out += "rotation(0, 0, 90)";
+        out.append(width - 1, '}');
+    }
+    return out;
+}
+
+// Loops nested `depth` deep, repeated.
+std::string generateNests(std::size_t approxBytes, int depth)
+{
+    std::string out = "init(50, 50, 50, 50)";
+    while (out.size() < approxBytes)
+    {
+        out += ";\n";
+        for (int i = 0; i < depth; ++i)
+            out += "iter { translation(1, 0);\n";
+        out += "rotation(0, 0, 90)";
+        out.append(depth, '}');
+    }
+    return out;
+}
+
+bool run(std::string_view shape, std::string source)
+{
+    std::stringstream diagOutput;
+    DiagnosticEmitter emitter(diagOutput, diagOutput);
+    Lexer lexer(std::string_view(source), emitter);
+    Parser parser(lexer, emitter);
+    auto context = parser.parse();
+    if (!context)
+    {
+        fmt::print(stderr, "Parsing failed: {}\n", diagOutput.str());
+        return false;
+    }
+    const std::size_t sourceBytes = source.size();
+    source = {};
+
+    double best = 1e300;
+    std::size_t blocks = 0;
+    std::size_t peak = 0;
+    for (int run = 0; run < 3; ++run)
+    {
+        const std::size_t before = liveBytes;
+        peakBytes = liveBytes;
+        Timer timer;
+        auto cfg = CFG::createCfg(context->getRoot());
+        best = std::min(best, timer.elapsedMs());
+        peak = peakBytes - before;
+        blocks = cfg.blocks().size();
+    }
+    fmt::print("{:<10} {:6.1f} MB source, {:8} blocks: {:8.2f} ms ({:5.1f} ns/block), "
+               "peak heap {:7.1f} MB ({:5.1f} B/block)\n",
+               shape, sourceBytes / 1048576.0, blocks, best, best * 1e6 / blocks,
+               peak / 1048576.0, static_cast<double>(peak) / blocks);
+    return true;
+}
+} // anonymous
+
+int main(int argc, const char* argv[])
+{
+    const std::size_t megabytes = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 16;
+    const std::size_t bytes = megabytes << 20;
+    if (!run("generated", generateProgram(bytes)) ||
+        !run("fan-8", generateFans(bytes, 8)) ||
+        !run("fan-256", generateFans(bytes, 256)) ||
+        !run("nest-8", generateNests(bytes, 8)) ||
+        !run("nest-256", generateNests(bytes, 256)))
+        return EXIT_FAILURE;
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,89 @@
+// Exporting the CFG of a generated program: the streaming exporters writing
+// to /dev/null compared to formatting the whole Dot graph in a
+// std::stringstream first. The streaming runs come first, the growth of the
+// peak RSS after the last run is the memory of the stringstream version.
+//
+// Usage: bench_cfg_export [MEGABYTES]
+
+#include <cstdlib>
+#include <sstream>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "benchmark/bench_support.h"
+#include "include/cfg.h"
+#include "include/cfg_export.h"
+#include "include/parser.h"
+
+namespace
+{
+// The Dot printer before the streaming exporters.
+std::string printWithStringstream(const CFG& cfg)
+{
+    std::stringstream out;
+    out << "digraph CFG {\n";
+    int counter = 0;
+    for (const auto& block : cfg.blocks())
+    {
+        out << "  Node_" << counter << R"([label=")";
+        for (auto op : block.operations())
+            out << print(toNode(op)) << R"(\n)";
+
+        out << "\"]\n";
+        ++counter;
+    }
+    out << '\n';
+    counter = 0;
+    for (const auto& block : cfg.blocks())
+    {
+        for (auto next : block.successors())
+            out << "  Node_" << counter << " -> " << "Node_" << next << "\n";
+
+        ++counter;
+    }
+    out << "}\n";
+    return std::move(out).str();
+}
+} // anonymous
+
+int main(int argc, const char* argv[])
+{
+    const std::size_t megabytes = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 32;
+    std::string source = generateProgram(megabytes << 20);
+    std::stringstream diagOutput;
+    DiagnosticEmitter emitter(diagOutput, diagOutput);
+    Lexer lexer(std::string_view(source), emitter);
+    Parser parser(lexer, emitter);
+    auto context = parser.parse();
+    if (!context)
+    {
+        fmt::print(stderr, "Parsing failed: {}\n", diagOutput.str());
+        return EXIT_FAILURE;
+    }
+    source = {};
+    auto cfg = CFG::createCfg(context->getRoot());
+    fmt::print("Input: {} MB, blocks: {}\n", megabytes, cfg.blocks().size());
+
+    const int devNull = open("/dev/null", O_WRONLY);
+    if (devNull < 0)
+        return EXIT_FAILURE;
+    for (auto [name, format] : {std::pair{"dot", CfgFormat::Dot}, std::pair{"json", CfgFormat::Json},
+                                std::pair{"edges", CfgFormat::EdgeList}})
+    {
+        Timer timer;
+        BufferedWriter writer(devNull);
+        exportCfg(cfg, format, writer);
+        writer.flush();
+        fmt::print("streamed {:<5}       {:8.2f} ms\n", name, timer.elapsedMs());
+    }
+    close(devNull);
+
+    const long rssBefore = peakRssKb();
+    Timer timer;
+    std::string text = printWithStringstream(cfg);
+    const double ms = timer.elapsedMs();
+    fmt::print("stringstream dot    {:8.2f} ms, {:.1f} MB of text, peak RSS +{:.1f} MB\n",
+               ms, text.size() / 1048576.0, (peakRssKb() - rssBefore) / 1024.0);
+    return EXIT_SUCCESS;
+}
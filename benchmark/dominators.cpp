@@ -0,0 +1,57 @@
+// Time to compute the dominators, the post-dominators and the loop-nesting
+// forest of generated programs of growing size. The times per block should
+// stay about the same.
+//
+// Usage: bench_dominators [MEGABYTES...]
+
+#include <cstdlib>
+#include <sstream>
+#include <vector>
+
+#include "benchmark/bench_support.h"
+#include "include/cfg.h"
+#include "include/parser.h"
+
+int main(int argc, const char* argv[])
+{
+    std::vector<std::size_t> sizes;
+    for (int i = 1; i < argc; ++i)
+        sizes.push_back(std::strtoul(argv[i], nullptr, 10));
+    if (sizes.empty())
+        sizes = {8, 32, 128};
+
+    for (std::size_t megabytes : sizes)
+    {
+        std::string source = generateProgram(megabytes << 20);
+        std::stringstream diagOutput;
+        DiagnosticEmitter emitter(diagOutput, diagOutput);
+        Lexer lexer(std::string_view(source), emitter);
+        Parser parser(lexer, emitter);
+        auto context = parser.parse();
+        if (!context)
+        {
+            fmt::print(stderr, "Parsing failed: {}\n", diagOutput.str());
+            return EXIT_FAILURE;
+        }
+        source = {};
+        auto cfg = CFG::createCfg(context->getRoot());
+        const double blocks = cfg.blocks().size();
+
+        Timer dominatorTimer;
+        cfg.dominators();
+        const double dominators = dominatorTimer.elapsedMs();
+        Timer postDominatorTimer;
+        cfg.postDominators();
+        const double postDominators = postDominatorTimer.elapsedMs();
+        Timer loopTimer;
+        cfg.loops();
+        const double loops = loopTimer.elapsedMs();
+
+        fmt::print("{:4} MB, {:8} blocks, {:6} loops: dominators {:8.2f} ms ({:5.1f} ns/block), "
+                   "post-dominators {:8.2f} ms ({:5.1f} ns/block), loops {:8.2f} ms ({:5.1f} ns/block)\n",
+                   megabytes, cfg.blocks().size(), cfg.loops().headers().size(),
+                   dominators, dominators * 1e6 / blocks, postDominators, postDominators * 1e6 / blocks,
+                   loops, loops * 1e6 / blocks);
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,66 @@
+// Traversal speed of the flat, per-kind array AST linked by 32-bit ids
+// compared to the pointer-linked ASTContext it is built from. Both are
+// walked by building the CFG and by pretty-printing the whole program.
+//
+// Usage: bench_flat_ast [MEGABYTES]
+
+#include <cstdlib>
+#include <sstream>
+
+#include "benchmark/bench_support.h"
+#include "include/cfg.h"
+#include "include/flat_ast.h"
+#include "include/parser.h"
+
+namespace
+{
+struct Timings
+{
+    double cfgMs = 0;
+    double printMs = 0;
+};
+
+template<typename AST>
+Timings measure(const AST& ast)
+{
+    Timings best{1e300, 1e300};
+    for (int run = 0; run < 3; ++run)
+    {
+        Timer cfgTimer;
+        auto cfg = CFG::createCfg(ast);
+        best.cfgMs = std::min(best.cfgMs, cfgTimer.elapsedMs());
+        Timer printTimer;
+        auto text = print(ast);
+        best.printMs = std::min(best.printMs, printTimer.elapsedMs());
+    }
+    return best;
+}
+} // anonymous
+
+int main(int argc, const char* argv[])
+{
+    const std::size_t megabytes = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 16;
+    std::string source = generateProgram(megabytes << 20);
+    std::stringstream diagOutput;
+    DiagnosticEmitter emitter(diagOutput, diagOutput);
+
+    Lexer lexer(std::string_view(source), emitter);
+    Parser parser(lexer, emitter);
+    auto context = parser.parse();
+    if (!context)
+    {
+        fmt::print(stderr, "Parsing failed: {}\n", diagOutput.str());
+        return EXIT_FAILURE;
+    }
+    fmt::print("Input: {} MB, nodes: {}\n", megabytes, context->getNodeCount());
+
+    Timings linked = measure(context->getRoot());
+    fmt::print("linked: cfg: {:8.2f} ms, print: {:8.2f} ms\n", linked.cfgMs, linked.printMs);
+
+    Timer flattenTimer;
+    auto ast = FlatAST::flatten(std::move(*context));
+    fmt::print("flatten:     {:8.2f} ms\n", flattenTimer.elapsedMs());
+    Timings flat = measure(ast);
+    fmt::print("flat:   cfg: {:8.2f} ms, print: {:8.2f} ms\n", flat.cfgMs, flat.printMs);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,108 @@
+// Re-analysis of a program after changing the immediates of one
+// translation at different positions in the source. Compares solving the
+// edited program from scratch to the incremental solver reusing the results
+// before the edit, the time of parsing and building the CFG is listed
+// separately.
+//
+// Usage: bench_incremental [MEGABYTES]
+
+#include <cstdlib>
+#include <optional>
+#include <sstream>
+
+#include "benchmark/bench_support.h"
+#include "include/block_mapping.h"
+#include "include/cfg.h"
+#include "include/dataflow/analyses/reachable_operations_analysis.h"
+#include "include/dataflow/solver.h"
+#include "include/parser.h"
+
+namespace
+{
+struct Program
+{
+    ASTContext context;
+    CFG cfg;
+};
+
+std::optional<Program> parse(std::string_view source)
+{
+    std::stringstream diagOutput;
+    DiagnosticEmitter emitter(diagOutput, diagOutput);
+    Lexer lexer(source, emitter);
+    Parser parser(lexer, emitter);
+    auto context = parser.parse();
+    if (!context)
+    {
+        fmt::print(stderr, "Parsing failed: {}\n", diagOutput.str());
+        return std::nullopt;
+    }
+    auto cfg = CFG::createCfg(context->getRoot());
+    return Program{std::move(*context), std::move(cfg)};
+}
+
+// Counts the applications of the transfer function.
+struct CountingTransfer
+{
+    StringSetDomain operator()(Operation op, StringSetDomain preState) const
+    {
+        ++count;
+        return ReachableOperationsTransfer{}(op, std::move(preState));
+    }
+
+    std::size_t& count;
+};
+} // anonymous
+
+int main(int argc, const char* argv[])
+{
+    const std::size_t megabytes = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 8;
+    const std::string source = generateProgram(megabytes << 20);
+    auto before = parse(source);
+    if (!before)
+        return EXIT_FAILURE;
+    const auto previous = getPastOperationsAnalysis(before->cfg);
+    fmt::print("{} MB, {} blocks\n", megabytes, before->cfg.blocks().size());
+
+    for (int percent : {10, 50, 90, 99})
+    {
+        // Turn the first "translation(" after the position into a rotation,
+        // that changes the past operations of every block after it.
+        std::string edited = source;
+        const auto position = edited.find("translation(", edited.size() / 100 * percent);
+        if (position == std::string::npos)
+            continue;
+        edited.replace(position, 12, "rotation(0, ");
+
+        Timer parseTimer;
+        auto after = parse(edited);
+        if (!after)
+            return EXIT_FAILURE;
+        const double parsing = parseTimer.elapsedMs();
+
+        std::size_t fullTransfers = 0;
+        Timer fullTimer;
+        auto full = solveMonotoneFramework<StringSetDomain, CountingTransfer, CFG, 0>(
+            after->cfg, CountingTransfer{fullTransfers});
+        const double fullMs = fullTimer.elapsedMs();
+
+        // The results before the edit are given up when solving incrementally.
+        auto reused = previous;
+        std::size_t incrementalTransfers = 0;
+        Timer mappingTimer;
+        BlockMapping mapping(before->cfg, after->cfg);
+        const double mappingMs = mappingTimer.elapsedMs();
+        Timer incrementalTimer;
+        auto incremental = solveMonotoneFrameworkIncrementally<StringSetDomain, CountingTransfer, CFG, 0>(
+            after->cfg, mapping, std::move(reused), CountingTransfer{incrementalTransfers});
+        const double incrementalMs = incrementalTimer.elapsedMs();
+
+        fmt::print("edit at {:2}%: parse and CFG {:7.2f} ms, {} changed blocks\n", percent, parsing,
+                   mapping.changedBlocks().size());
+        fmt::print("  {:<12} {:8} transfers {:8.2f} ms\n", "full", fullTransfers, fullMs);
+        fmt::print("  {:<12} {:8} transfers {:8.2f} ms (+{:.2f} ms mapping){}\n", "incremental",
+                   incrementalTransfers, incrementalMs, mappingMs,
+                   incremental == full ? "" : ", DIFFERENT RESULTS");
+    }
+    return EXIT_SUCCESS;
+}
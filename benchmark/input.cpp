@@ -0,0 +1,105 @@
+// Compares reading the input through iostreams (copying it) with lexing
+// a memory-mapped file. Every mode runs in a separate process so the
+// peak RSS numbers are not polluted by the other modes.
+//
+// Usage: bench_input [MEGABYTES]
+
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "benchmark/bench_support.h"
+#include "include/lexer.h"
+
+namespace
+{
+enum class Mode { Copy, Mmap };
+
+// Lexes tokens on demand up to the end of the input, recording when the
+// first token is available. Returns the number of tokens.
+std::size_t lexTokens(Lexer& lexer, const Timer& timer, double& firstTokenMs, long& firstTokenRss)
+{
+    std::size_t count = 0;
+    for (auto token = lexer.next(); token; token = lexer.next())
+    {
+        if (count++ == 0)
+        {
+            firstTokenMs = timer.elapsedMs();
+            firstTokenRss = peakRssKb();
+        }
+        if (token->type == TokenType::END_OF_FILE)
+            break;
+    }
+    return count;
+}
+
+void runMode(Mode mode, const std::string& path)
+{
+    std::stringstream diagOutput;
+    DiagnosticEmitter emitter(diagOutput, diagOutput);
+    Timer timer;
+    std::size_t tokenCount = 0;
+    double firstTokenMs = 0;
+    long firstTokenRss = 0;
+    if (mode == Mode::Copy)
+    {
+        // What the driver used to do.
+        std::ifstream file(path);
+        std::stringstream fileContent;
+        fileContent << file.rdbuf();
+        Lexer lexer(std::move(fileContent).str(), emitter);
+        tokenCount = lexTokens(lexer, timer, firstTokenMs, firstTokenRss);
+    }
+    else
+    {
+        auto file = SourceFile::open(path);
+        if (!file || !file->isMapped())
+        {
+            fmt::print(stderr, "Failed to map '{}'.\n", path);
+            std::exit(EXIT_FAILURE);
+        }
+        Lexer lexer(file->content(), emitter);
+        tokenCount = lexTokens(lexer, timer, firstTokenMs, firstTokenRss);
+    }
+    fmt::print("{:<6} time to first token: {:9.2f} ms, peak RSS at first token: {:8} KB, "
+               "total: {:9.2f} ms, peak RSS: {:8} KB, tokens: {}\n",
+               mode == Mode::Copy ? "copy" : "mmap", firstTokenMs, firstTokenRss,
+               timer.elapsedMs(), peakRssKb(), tokenCount);
+}
+} // anonymous
+
+int main(int argc, const char* argv[])
+{
+    const std::size_t megabytes = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 64;
+    auto path = std::filesystem::temp_directory_path() / fmt::format("bench_input_{}.tr", getpid());
+    {
+        std::ofstream out(path);
+        out << generateProgram(megabytes << 20);
+    }
+    fmt::print("Input: {} MB\n", megabytes);
+    std::fflush(stdout);
+
+    int status = EXIT_SUCCESS;
+    for (Mode mode : {Mode::Copy, Mode::Mmap})
+    {
+        pid_t child = fork();
+        if (child == 0)
+        {
+            runMode(mode, path.string());
+            std::fflush(stdout);
+            std::_Exit(EXIT_SUCCESS);
+        }
+        int childStatus = 0;
+        waitpid(child, &childStatus, 0);
+        if (!WIFEXITED(childStatus) || WEXITSTATUS(childStatus) != EXIT_SUCCESS)
+            status = EXIT_FAILURE;
+    }
+    std::filesystem::remove(path);
+    return status;
+}
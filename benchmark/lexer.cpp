@@ -0,0 +1,74 @@
+// Lexer throughput with the different scanning primitives on synthetic
+// inputs dominated by whitespace, comments and number literals.
+//
+// Usage: bench_lexer [MEGABYTES]
+
+#include <algorithm>
+#include <cstdlib>
+#include <limits>
+#include <sstream>
+#include <utility>
+#include <vector>
+
+#include "benchmark/bench_support.h"
+#include "include/lexer.h"
+
+namespace
+{
+std::string repeatUntil(std::size_t size, std::string_view chunk)
+{
+    std::string result;
+    result.reserve(size + chunk.size());
+    while (result.size() < size)
+        result += chunk;
+    return result;
+}
+} // anonymous
+
+int main(int argc, const char* argv[])
+{
+    const std::size_t megabytes = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 32;
+    const std::size_t size = megabytes << 20;
+    std::vector<std::pair<std::string_view, std::string>> inputs;
+    inputs.emplace_back("program", generateProgram(size));
+    inputs.emplace_back("whitespace", repeatUntil(size, "translation(1, 2);\n                                \t\t\r\n"));
+    inputs.emplace_back("comments", repeatUntil(size, "/* translation(1, 2); rotation(1, 2, 3); */ 1 // iter { translation(1, 2) }\n"));
+    inputs.emplace_back("numbers", repeatUntil(size, "1234567890, -2147483648, 0000000000000000000000000012, "));
+
+    std::stringstream diagOutput;
+    DiagnosticEmitter emitter(diagOutput, diagOutput);
+    for (const auto& [name, source] : inputs)
+    {
+        for (ScanIsa isa : {ScanIsa::Scalar, ScanIsa::SSE2, ScanIsa::AVX2})
+        {
+            if (!isSupported(isa))
+                continue;
+            // Best of a few runs to reduce the noise.
+            double ms = std::numeric_limits<double>::max();
+            std::size_t tokens = 0;
+            for (int run = 0; run < 3; ++run)
+            {
+                Lexer lexer(std::string_view(source), emitter);
+                lexer.useScanIsa(isa);
+                Timer timer;
+                tokens = 0;
+                while (true)
+                {
+                    auto token = lexer.next();
+                    if (!token)
+                    {
+                        fmt::print(stderr, "Lexing failed: {}\n", diagOutput.str());
+                        return EXIT_FAILURE;
+                    }
+                    ++tokens;
+                    if (token->type == TokenType::END_OF_FILE)
+                        break;
+                }
+                ms = std::min(ms, timer.elapsedMs());
+            }
+            fmt::print("{:<10} {:<6} {:8.1f} MB/s ({} tokens)\n", name, toString(isa),
+                       static_cast<double>(source.size()) / (1 << 20) / (ms / 1000), tokens);
+        }
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,100 @@
+// Cost and precision of the descending iteration after widening in the
+// interval analysis. Compares widening at every block to widening followed
+// by narrowing on a generated program and on the given scripts, the
+// precision is the number of finite bounds in the states of the blocks.
+//
+// Usage: bench_narrowing [MEGABYTES] [SCRIPT...]
+
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+
+#include "benchmark/bench_support.h"
+#include "include/dataflow/analyses/interval_analysis.h"
+#include "include/dataflow/solver.h"
+#include "include/parser.h"
+
+namespace
+{
+// Counts the applications of the transfer function.
+struct CountingTransfer
+{
+    Vec2Interval operator()(Operation op, Vec2Interval preState) const
+    {
+        ++count;
+        return IntervalTransfer{}(op, preState);
+    }
+
+    std::size_t& count;
+};
+
+std::size_t finiteBounds(const std::vector<Vec2Interval>& states)
+{
+    std::size_t count = 0;
+    for (const Vec2Interval& state : states)
+    {
+        if (state == Vec2Interval::bottom())
+            continue;
+        for (IntervalDomain interval : {state.x, state.y})
+            count += (interval.min != NEG_INF) + (interval.max != INF);
+    }
+    return count;
+}
+
+template<typename Solve>
+void run(std::string_view name, Solve solve)
+{
+    std::size_t transfers = 0;
+    Timer timer;
+    auto result = solve(CountingTransfer{transfers});
+    const double ms = timer.elapsedMs();
+    if (result.empty())
+        fmt::print("  {:<10} did not converge\n", name);
+    else
+        fmt::print("  {:<10} {:9} transfers {:8.2f} ms, {:8} finite bounds\n", name, transfers, ms,
+                   finiteBounds(result));
+}
+
+bool benchmark(std::string_view name, std::string_view source)
+{
+    std::stringstream diagOutput;
+    DiagnosticEmitter emitter(diagOutput, diagOutput);
+    Lexer lexer(source, emitter);
+    Parser parser(lexer, emitter);
+    auto context = parser.parse();
+    if (!context)
+    {
+        fmt::print(stderr, "Parsing {} failed: {}\n", name, diagOutput.str());
+        return false;
+    }
+    auto cfg = CFG::createCfg(context->getRoot());
+    fmt::print("{}: {} blocks\n", name, cfg.blocks().size());
+    run("widening", [&](CountingTransfer transfer) {
+        return solveMonotoneFrameworkWithWidening<Vec2Interval, CountingTransfer, CFG, 0>(cfg, transfer);
+    });
+    run("narrowing", [&](CountingTransfer transfer) {
+        return solveMonotoneFrameworkWithNarrowing<Vec2Interval, CountingTransfer, CFG, 0>(cfg, transfer);
+    });
+    return true;
+}
+} // anonymous
+
+int main(int argc, const char* argv[])
+{
+    const std::size_t megabytes = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 8;
+    bool success = benchmark(fmt::format("generated {} MB", megabytes), generateProgram(megabytes << 20));
+    for (int i = 2; i < argc; ++i)
+    {
+        std::ifstream file(argv[i]);
+        if (!file)
+        {
+            fmt::print(stderr, "Cannot open {}\n", argv[i]);
+            success = false;
+            continue;
+        }
+        std::stringstream source;
+        source << file.rdbuf();
+        success = benchmark(argv[i], source.str()) && success;
+    }
+    return success ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,75 @@
+// Scaling of the parallel solver from 1 to MAX_THREADS threads compared to
+// the sequential solveMonotoneFramework on a wide program: a loop around
+// ARMS independent alternatives of ARM_LENGTH operations each.
+//
+// Usage: bench_parallel_solver [ARMS] [ARM_LENGTH] [MAX_THREADS]
+
+#include <cstdlib>
+#include <sstream>
+#include <thread>
+
+#include "benchmark/bench_support.h"
+#include "include/dataflow/analyses/reachable_operations_analysis.h"
+#include "include/dataflow/analyses/sign_analysis.h"
+#include "include/dataflow/parallel_solver.h"
+#include "include/dataflow/solver.h"
+#include "include/parser.h"
+
+namespace
+{
+template<typename Sequential, typename Parallel>
+bool run(std::string_view name, Sequential sequential, Parallel parallel, unsigned maxThreads)
+{
+    Timer timer;
+    const auto expected = sequential();
+    const double sequentialMs = timer.elapsedMs();
+    fmt::print("{:<16} sequential {:8.2f} ms\n", name, sequentialMs);
+    bool same = true;
+    for (unsigned threads = 1; threads <= maxThreads; ++threads)
+    {
+        Timer parallelTimer;
+        const auto result = parallel(threads);
+        const double ms = parallelTimer.elapsedMs();
+        fmt::print("{:<16} {:2} threads {:8.2f} ms, {:5.2f}x{}\n", name, threads, ms, sequentialMs / ms,
+                   result == expected ? "" : ", DIFFERENT RESULTS");
+        same = same && result == expected;
+    }
+    return same;
+}
+} // anonymous
+
+int main(int argc, const char* argv[])
+{
+    const int arms = argc > 1 ? std::atoi(argv[1]) : 50000;
+    const int armLength = argc > 2 ? std::atoi(argv[2]) : 8;
+    const unsigned maxThreads = argc > 3 ? std::strtoul(argv[3], nullptr, 10)
+                                         : std::max(4u, std::thread::hardware_concurrency());
+    std::string source = generateWideProgram(arms, armLength);
+    std::stringstream diagOutput;
+    DiagnosticEmitter emitter(diagOutput, diagOutput);
+
+    Lexer lexer(std::string_view(source), emitter);
+    Parser parser(lexer, emitter);
+    auto context = parser.parse();
+    if (!context)
+    {
+        fmt::print(stderr, "Parsing failed: {}\n", diagOutput.str());
+        return EXIT_FAILURE;
+    }
+    source = {};
+    auto cfg = CFG::createCfg(context->getRoot());
+    fmt::print("Arms: {}, operations per arm: {}, blocks: {}, hardware threads: {}\n", arms, armLength,
+               cfg.blocks().size(), std::thread::hardware_concurrency());
+
+    bool same = run("sign", [&] {
+        return solveMonotoneFramework<Vec2Sign, SignTransfer, CFG, 0>(cfg);
+    }, [&](unsigned threads) {
+        return solveMonotoneFrameworkInParallel<Vec2Sign, SignTransfer, CFG, 0>(cfg, threads);
+    }, maxThreads);
+    same = run("past-operations", [&] {
+        return solveMonotoneFramework<StringSetDomain, ReachableOperationsTransfer, CFG, 0>(cfg);
+    }, [&](unsigned threads) {
+        return solveMonotoneFrameworkInParallel<StringSetDomain, ReachableOperationsTransfer, CFG, 0>(cfg, threads);
+    }, maxThreads) && same;
+    return same ? EXIT_SUCCESS : EXIT_FAILURE;
+}
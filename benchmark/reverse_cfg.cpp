@@ -0,0 +1,57 @@
+// Side-by-side times of the forward past-operations analysis and of the
+// backward future-operations analysis on the ReverseCFG view and on the
+// materialized reverse CFG. The materialized run should be as fast as the
+// forward one.
+//
+// Usage: bench_reverse_cfg [MEGABYTES]
+
+#include <cstdlib>
+#include <sstream>
+
+#include "benchmark/bench_support.h"
+#include "include/cfg.h"
+#include "include/dataflow/analyses/reachable_operations_analysis.h"
+#include "include/parser.h"
+
+int main(int argc, const char* argv[])
+{
+    const std::size_t megabytes = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 8;
+    std::string source = generateProgram(megabytes << 20);
+    std::stringstream diagOutput;
+    DiagnosticEmitter emitter(diagOutput, diagOutput);
+    Lexer lexer(std::string_view(source), emitter);
+    Parser parser(lexer, emitter);
+    auto context = parser.parse();
+    if (!context)
+    {
+        fmt::print(stderr, "Parsing failed: {}\n", diagOutput.str());
+        return EXIT_FAILURE;
+    }
+    source = {};
+    auto cfg = CFG::createCfg(context->getRoot());
+    fmt::print("{} MB, {} blocks\n", megabytes, cfg.blocks().size());
+
+    Timer forwardTimer;
+    auto past = getPastOperationsAnalysis(cfg);
+    fmt::print("{:<34} {:8.2f} ms\n", "past-operations on CFG", forwardTimer.elapsedMs());
+
+    Timer viewTimer;
+    ReverseCFG view(cfg);
+    auto futureOnView = getFutureOperationsAnalysis(view);
+    fmt::print("{:<34} {:8.2f} ms\n", "future-operations on ReverseCFG", viewTimer.elapsedMs());
+
+    Timer materializeTimer;
+    MaterializedReverseCFG materialized(cfg);
+    const double materializing = materializeTimer.elapsedMs();
+    Timer materializedTimer;
+    auto futureOnMaterialized = getFutureOperationsAnalysis(materialized);
+    fmt::print("{:<34} {:8.2f} ms (+{:.2f} ms to materialize)\n", "future-operations on materialized",
+               materializedTimer.elapsedMs(), materializing);
+
+    if (futureOnView != futureOnMaterialized || past.size() != futureOnView.size())
+    {
+        fmt::print(stderr, "The results of the reverse CFGs differ\n");
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,110 @@
+// Solver speed on the contiguous (compressed sparse row) CFG compared to
+// a CFG where every block owns its vectors, which is how CFG used to
+// store the blocks, and to the simplified CFG without empty blocks and
+// straight-line chains. The default input size gives about 1M blocks.
+//
+// Usage: bench_solver [MEGABYTES]
+
+#include <cstdlib>
+#include <sstream>
+
+#include "benchmark/bench_support.h"
+#include "include/dataflow/analyses/interval_analysis.h"
+#include "include/dataflow/analyses/sign_analysis.h"
+#include "include/dataflow/solver.h"
+#include "include/parser.h"
+
+namespace
+{
+class VectorBlock
+{
+public:
+    explicit VectorBlock(const BasicBlock& block)
+        : ops(block.operations().begin(), block.operations().end()),
+          succs(block.successors().begin(), block.successors().end()),
+          preds(block.predecessors().begin(), block.predecessors().end()) {}
+
+    const std::vector<Operation>& operations() const noexcept { return ops; }
+    const std::vector<int>& successors() const noexcept { return succs; }
+    const std::vector<int>& predecessors() const noexcept { return preds; }
+
+private:
+    std::vector<Operation> ops;
+    std::vector<int> succs;
+    std::vector<int> preds;
+};
+
+class VectorCfg
+{
+public:
+    explicit VectorCfg(const CFG& cfg)
+    {
+        for (const auto& block : cfg.blocks())
+            vectorBlocks.emplace_back(block);
+    }
+
+    const std::vector<VectorBlock>& blocks() const noexcept { return vectorBlocks; }
+
+private:
+    std::vector<VectorBlock> vectorBlocks;
+};
+
+static_assert(CfgConcept<VectorCfg>);
+
+template<typename Solve>
+double bestOf3(Solve solve)
+{
+    double best = 1e300;
+    for (int run = 0; run < 3; ++run)
+    {
+        Timer timer;
+        auto result = solve();
+        best = std::min(best, timer.elapsedMs());
+        if (result.empty())
+            fmt::print(stderr, "The analysis did not converge.\n");
+    }
+    return best;
+}
+
+template<CfgConcept G>
+void runSolvers(std::string_view name, const G& cfg)
+{
+    double sign = bestOf3([&] {
+        return solveMonotoneFramework<Vec2Sign, SignTransfer, G, 0>(cfg);
+    });
+    double interval = bestOf3([&] {
+        return solveMonotoneFrameworkWithWidening<Vec2Interval, IntervalTransfer, G, 0>(cfg);
+    });
+    fmt::print("{:>10}: sign: {:8.2f} ms, interval: {:8.2f} ms\n", name, sign, interval);
+}
+} // anonymous
+
+int main(int argc, const char* argv[])
+{
+    const std::size_t megabytes = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 88;
+    std::string source = generateProgram(megabytes << 20);
+    std::stringstream diagOutput;
+    DiagnosticEmitter emitter(diagOutput, diagOutput);
+
+    Lexer lexer(std::string_view(source), emitter);
+    Parser parser(lexer, emitter);
+    auto context = parser.parse();
+    if (!context)
+    {
+        fmt::print(stderr, "Parsing failed: {}\n", diagOutput.str());
+        return EXIT_FAILURE;
+    }
+    source = {};
+    auto cfg = CFG::createCfg(context->getRoot());
+    VectorCfg vectorCfg(cfg);
+    fmt::print("Input: {} MB, blocks: {}\n", megabytes, cfg.blocks().size());
+
+    runSolvers("csr", cfg);
+    runSolvers("vectors", vectorCfg);
+
+    Timer timer;
+    auto simplified = cfg.simplify();
+    fmt::print("Simplified in {:.2f} ms, blocks: {}\n", timer.elapsedMs(), simplified.cfg.blocks().size());
+    runSolvers("simplified", simplified.cfg);
+    return EXIT_SUCCESS;
+}
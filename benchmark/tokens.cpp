@@ -0,0 +1,39 @@
+// Compares the memory used by the struct-of-arrays TokenBuffer with
+// storing the unpacked tokens in a vector.
+//
+// Usage: bench_tokens [MEGABYTES]
+
+#include <cstdlib>
+#include <sstream>
+#include <vector>
+
+#include "benchmark/bench_support.h"
+#include "include/lexer.h"
+
+int main(int argc, const char* argv[])
+{
+    const std::size_t megabytes = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 32;
+    std::string source = generateProgram(megabytes << 20);
+
+    std::stringstream diagOutput;
+    DiagnosticEmitter emitter(diagOutput, diagOutput);
+    Lexer lexer(std::string_view(source), emitter);
+    Timer timer;
+    TokenBuffer buffer = lexer.lexAll();
+    double lexMs = timer.elapsedMs();
+    if (buffer.empty())
+    {
+        fmt::print(stderr, "Lexing failed: {}\n", diagOutput.str());
+        return EXIT_FAILURE;
+    }
+
+    std::vector<Token> unpacked(buffer.begin(), buffer.end());
+    const std::size_t unpackedBytes = unpacked.size() * sizeof(Token);
+    fmt::print("Input: {} MB, tokens: {}, lexing: {:.2f} ms\n", megabytes, buffer.size(), lexMs);
+    fmt::print("std::vector<Token>: {:10} bytes ({:.2f} bytes/token)\n",
+               unpackedBytes, static_cast<double>(unpackedBytes) / buffer.size());
+    fmt::print("TokenBuffer:        {:10} bytes ({:.2f} bytes/token)\n",
+               buffer.memoryUsage(), static_cast<double>(buffer.memoryUsage()) / buffer.size());
+    fmt::print("Ratio: {:.2f}x\n", static_cast<double>(unpackedBytes) / buffer.memoryUsage());
+    return EXIT_SUCCESS;
+}
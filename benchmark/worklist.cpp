@@ -0,0 +1,69 @@
+// The solvers with the priority queue based RPOWorklist compared to the
+// BitsetRPOWorklist on programs with deeply nested loops.
+//
+// Usage: bench_worklist [MEGABYTES] [MAX_LOOP_DEPTH]
+
+#include <cstdlib>
+#include <sstream>
+
+#include "benchmark/bench_support.h"
+#include "include/dataflow/analyses/interval_analysis.h"
+#include "include/dataflow/analyses/sign_analysis.h"
+#include "include/dataflow/solver.h"
+#include "include/parser.h"
+
+namespace
+{
+template<typename Solve>
+double bestOf3(Solve solve)
+{
+    double best = 1e300;
+    for (int run = 0; run < 3; ++run)
+    {
+        Timer timer;
+        auto result = solve();
+        best = std::min(best, timer.elapsedMs());
+        if (result.empty())
+            fmt::print(stderr, "The analysis did not converge.\n");
+    }
+    return best;
+}
+
+template<template<typename> typename Worklist>
+void runSolvers(std::string_view name, const CFG& cfg)
+{
+    double sign = bestOf3([&] {
+        return solveMonotoneFramework<Vec2Sign, SignTransfer, CFG, 0, Worklist>(cfg);
+    });
+    double interval = bestOf3([&] {
+        return solveMonotoneFrameworkWithWidening<Vec2Interval, IntervalTransfer, CFG, 0, Worklist>(cfg);
+    });
+    fmt::print("{:>7}: sign: {:8.2f} ms, interval: {:8.2f} ms\n", name, sign, interval);
+}
+} // anonymous
+
+int main(int argc, const char* argv[])
+{
+    const std::size_t megabytes = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 16;
+    const int maxDepth = argc > 2 ? std::atoi(argv[2]) : 16;
+    std::string source = generateProgram(megabytes << 20, maxDepth);
+    std::stringstream diagOutput;
+    DiagnosticEmitter emitter(diagOutput, diagOutput);
+
+    Lexer lexer(std::string_view(source), emitter);
+    Parser parser(lexer, emitter);
+    auto context = parser.parse();
+    if (!context)
+    {
+        fmt::print(stderr, "Parsing failed: {}\n", diagOutput.str());
+        return EXIT_FAILURE;
+    }
+    source = {};
+    auto cfg = CFG::createCfg(context->getRoot());
+    fmt::print("Input: {} MB, max loop depth: {}, blocks: {}, back edges: {}\n", megabytes,
+               maxDepth, cfg.blocks().size(), cfg.dfsTree().backEdges().size());
+
+    runSolvers<RPOWorklist>("heap", cfg);
+    runSolvers<BitsetRPOWorklist>("bitset", cfg);
+    return EXIT_SUCCESS;
+}
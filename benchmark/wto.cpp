@@ -0,0 +1,83 @@
+// Iteration counts of the interval analysis when widening at every block in
+// RPO compared to Bourdoncle's strategy over a weak topological order and to
+// solving the strongly connected components one at a time. The times of the
+// latter two do not include building the order and the components.
+//
+// Usage: bench_wto [MEGABYTES] [MAX_LOOP_DEPTH]
+
+#include <cstdlib>
+#include <sstream>
+
+#include "benchmark/bench_support.h"
+#include "include/dataflow/analyses/interval_analysis.h"
+#include "include/dataflow/solver.h"
+#include "include/parser.h"
+
+namespace
+{
+// Counts the applications of the transfer function.
+struct CountingTransfer
+{
+    Vec2Interval operator()(Operation op, Vec2Interval preState) const
+    {
+        ++count;
+        return IntervalTransfer{}(op, preState);
+    }
+
+    std::size_t& count;
+};
+
+template<typename Solve>
+void run(std::string_view name, Solve solve, std::size_t blocks)
+{
+    std::size_t transfers = 0;
+    Timer timer;
+    auto result = solve(CountingTransfer{transfers});
+    const double ms = timer.elapsedMs();
+    if (result.empty())
+        fmt::print("{:>6}: did not converge\n", name);
+    else
+        fmt::print("{:>6}: {:9} transfers, {:5.2f} per block, {:8.2f} ms\n", name, transfers,
+                   static_cast<double>(transfers) / blocks, ms);
+}
+} // anonymous
+
+int main(int argc, const char* argv[])
+{
+    const std::size_t megabytes = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 16;
+    const int maxDepth = argc > 2 ? std::atoi(argv[2]) : 16;
+    std::string source = generateProgram(megabytes << 20, maxDepth);
+    std::stringstream diagOutput;
+    DiagnosticEmitter emitter(diagOutput, diagOutput);
+
+    Lexer lexer(std::string_view(source), emitter);
+    Parser parser(lexer, emitter);
+    auto context = parser.parse();
+    if (!context)
+    {
+        fmt::print(stderr, "Parsing failed: {}\n", diagOutput.str());
+        return EXIT_FAILURE;
+    }
+    source = {};
+    auto cfg = CFG::createCfg(context->getRoot());
+    const std::size_t blocks = cfg.blocks().size();
+    fmt::print("Input: {} MB, max loop depth: {}, blocks: {}, back edges: {}\n", megabytes,
+               maxDepth, blocks, cfg.dfsTree().backEdges().size());
+    Timer wtoTimer;
+    WeakTopologicalOrder wto(cfg);
+    fmt::print("Weak topological order built in {:.2f} ms\n", wtoTimer.elapsedMs());
+    Timer sccTimer;
+    StronglyConnectedComponents sccs(cfg);
+    fmt::print("Strongly connected components built in {:.2f} ms\n", sccTimer.elapsedMs());
+
+    run("rpo", [&](CountingTransfer transfer) {
+        return solveMonotoneFrameworkWithWidening<Vec2Interval, CountingTransfer, CFG, 0>(cfg, transfer);
+    }, blocks);
+    run("wto", [&](CountingTransfer transfer) {
+        return solveMonotoneFrameworkWithWto<Vec2Interval, CountingTransfer, CFG, 0>(cfg, wto, transfer);
+    }, blocks);
+    run("scc", [&](CountingTransfer transfer) {
+        return solveMonotoneFrameworkWithScc<Vec2Interval, CountingTransfer, CFG, 0>(cfg, sccs, transfer);
+    }, blocks);
+    return EXIT_SUCCESS;
+}
@@ -1,6 +1,11 @@
 #ifndef AST_H
 #define AST_H
 
+#include <cstdint>
+#include <memory>
+#include <memory_resource>
+#include <span>
+#include <type_traits>
 #include <variant>
 #include <vector>
 #include <unordered_map>
@@ -19,47 +24,59 @@ struct Loop;
 using Node = std::variant<const Init*, const Translation*, const Rotation*,
                           const Sequence*, const Branch*, const Loop*>;
 
+// The kinds of the nodes, in the order of the alternatives of Node.
+enum class NodeKind : std::uint8_t
+{
+    Init, Translation, Rotation, Sequence, Branch, Loop
+};
+
+// The keywords refer to the tokens stored in the ASTContext, the values
+// of the number literals are stored inline.
 struct Init
 {
-    Token kw;
-    Token topX, topY;
-    Token width, height;
+    TokenId kw;
+    int topX, topY;
+    int width, height;
 };
 
 struct Translation
 {
-    Token kw;
-    Token x, y;
+    TokenId kw;
+    int x, y;
 };
 
 struct Rotation
 {
-    Token kw;
-    Token x, y, deg;
+    TokenId kw;
+    int x, y, deg;
 };
 
 struct Sequence
 {
-    std::vector<Node> nodes;
+    // Points into the arena of the ASTContext.
+    std::span<const Node> nodes;
 };
 
 struct Branch
 {
-    Token kw;
+    TokenId kw;
     const Sequence* lhs;
     const Sequence* rhs;
 };
 
 struct Loop
 {
-    Token kw;
+    TokenId kw;
     const Sequence* body;
 };
 
+// Owns the AST nodes. The nodes are allocated from a monotonic arena and
+// they are all trivially destructible, so destroying the context only
+// releases a handful of large blocks.
 class ASTContext
 {
 public:
-    ASTContext() = default;
+    ASTContext() : arena(std::make_unique<std::pmr::monotonic_buffer_resource>()) {}
     ASTContext(ASTContext&&) = default;
     ASTContext& operator=(ASTContext&&) = default;
     ASTContext(const ASTContext&) = delete;
@@ -68,33 +85,67 @@ public:
     template<typename T, typename... Args>
     const T* make(Args&&... args)
     {
-        const T* ret = new T(std::forward<Args&&>(args)...);
-        nodes.push_back(ret);
+        static_assert(std::is_trivially_destructible_v<T>, "Nodes are never destroyed.");
+        void* mem = arena->allocate(sizeof(T), alignof(T));
+        const T* ret = new (mem) T(std::forward<Args&&>(args)...);
+        lastNode = ret;
+        ++nodeCount;
         return ret;
     }
 
-    const Sequence* getRoot() const {
-        Node root = nodes.back();
-        assert(std::holds_alternative<const Sequence*>(root));
-        return std::get<const Sequence*>(root);
-    }
-
-    ~ASTContext()
+    const Sequence* makeSequence(std::span<const Node> nodes)
     {
-        for (auto node : nodes)
+        Node* children = nullptr;
+        if (!nodes.empty())
         {
-            std::visit(nodeDeleter, node);
+            void* mem = arena->allocate(nodes.size_bytes(), alignof(Node));
+            children = static_cast<Node*>(mem);
+            std::uninitialized_copy(nodes.begin(), nodes.end(), children);
         }
+        return make<Sequence>(std::span<const Node>(children, nodes.size()));
     }
 
-private:
-    std::vector<Node> nodes;
+    // The root is the last node created.
+    const Sequence* getRoot() const {
+        assert(std::holds_alternative<const Sequence*>(lastNode));
+        return std::get<const Sequence*>(lastNode);
+    }
+
+    // Only the tokens referenced by the AST are stored.
+    TokenId addToken(const Token& t) { return tokens.push(t); }
+    const TokenBuffer& getTokens() const { return tokens; }
+    SourceLocation getLocation(TokenId id) const { return tokens.location(id); }
+    void setLocations(LocationTable table) { tokens.setLocations(std::move(table)); }
+    TokenBuffer takeTokens() { return std::move(tokens); }
 
-    struct {
-        void operator()(const auto* p) const noexcept { delete p; }
-    } nodeDeleter;
+    std::size_t getNodeCount() const { return nodeCount; }
+
+private:
+    std::unique_ptr<std::pmr::monotonic_buffer_resource> arena;
+    Node lastNode;
+    std::size_t nodeCount = 0;
+    TokenBuffer tokens;
 };
 
+static_assert(std::is_trivially_destructible_v<Sequence>);
+
+// The structure of the pointer based AST through the same interface as
+// FlatAST, so the algorithms walking the tree are written once for both.
+struct LinkedAST
+{
+    using NodeRef = Node;
+
+    static NodeKind kind(Node n) noexcept { return static_cast<NodeKind>(n.index()); }
+    // The pointer to an Init, Translation or Rotation node.
+    static Node getNode(Node n) noexcept { return n; }
+    static std::span<const Node> children(Node sequence) noexcept
+    {
+        return std::get<const Sequence*>(sequence)->nodes;
+    }
+    static Node lhs(Node branch) noexcept { return std::get<const Branch*>(branch)->lhs; }
+    static Node rhs(Node branch) noexcept { return std::get<const Branch*>(branch)->rhs; }
+    static Node body(Node loop) noexcept { return std::get<const Loop*>(loop)->body; }
+};
 
 // Utility to attach information before and after AST nodes that
 // can be rendered by pretty-printing the AST. This can be useful
@@ -106,7 +157,12 @@ struct Annotations
     AnnotationMap postAnnotations; // Rendered after the node.
 };
 
+class FlatAST;
+
 std::string print(Node n, const Annotations& anns = {}) noexcept;
+// Only the annotations of the operations are rendered, the other nodes of
+// a FlatAST have no Node.
+std::string print(const FlatAST& ast, const Annotations& anns = {}) noexcept;
 
 // TODO: add recursive AST visitor.
 
@@ -0,0 +1,43 @@
+#ifndef BLOCK_MAPPING_H
+#define BLOCK_MAPPING_H
+
+#include <span>
+#include <vector>
+
+#include "include/cfg.h"
+
+// The correspondence between the blocks of the CFGs of a program before and
+// after an edit. The blocks are numbered in the order of the AST, so an edit
+// shifts the numbers of the blocks after it by the same amount. The blocks
+// of the common prefix and suffix with equivalent operations are candidates,
+// a candidate is unchanged when its predecessors are the candidates of the
+// predecessors of the old block. All the other blocks are changed.
+//
+// An unchanged block that cannot be reached from a changed block has the
+// same unchanged blocks before it in both CFGs, so the states of a forward
+// analysis of the old CFG can be reused for it. The reversed mapping
+// compares the successors instead.
+class BlockMapping
+{
+public:
+    BlockMapping(const CFG& before, const CFG& after);
+
+    // The block before the edit, -1 for the changed blocks.
+    int previous(int block) const noexcept { return previousBlocks[block]; }
+    // The changed blocks after the edit, in increasing order.
+    std::span<const int> changedBlocks() const noexcept { return changed; }
+    // The same mapping between the ReverseCFGs of the two CFGs.
+    BlockMapping reversed() const;
+
+private:
+    BlockMapping() = default;
+
+    std::vector<int> previousBlocks;
+    std::vector<int> changed;
+    // The same with the successors compared, the blocks are not reversed.
+    std::vector<int> previousBlocksBySuccessors;
+    std::vector<int> changedBySuccessors;
+    int previousSize = 0;
+};
+
+#endif // BLOCK_MAPPING_H
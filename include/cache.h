@@ -0,0 +1,59 @@
+#ifndef CACHE_H
+#define CACHE_H
+
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include "include/cfg.h"
+#include "include/flat_ast.h"
+
+// A program loaded from a cache file. The arrays of the AST and the CFG
+// are views of the file, the operations in the CFG refer to the nodes of
+// the AST.
+struct CachedProgram
+{
+    FlatAST ast;
+    CFG cfg;
+    // Empty when the program was not loaded from a file, e.g., it was just
+    // written to one, or the caller keeps the image alive.
+    std::optional<SourceFile> file{};
+};
+
+// Versioned binary image of a parsed program, so the same program can be
+// analyzed many times without lexing, parsing and building the CFG again.
+// The image stores the flat AST with the tokens it references, the CFG
+// with its operations and its DFS tree. Every array is stored in its
+// in-memory layout at an 8-byte aligned offset, so a loaded program views
+// the arrays in the memory-mapped file and nothing is copied or computed
+// per node. Only the blocks of the CFG are set up, they point into the
+// arrays. Files written by a different version or on a machine with a
+// different byte order are rejected.
+//
+// Every reference is validated before it is used, and the DFS tree has to
+// be consistent with the edges of the CFG. On a generated 16 MB program
+// (bench_cache), loading is about 12x faster than lexing, parsing and
+// building the CFG, most of the loading time is the validation. The image
+// is about twice the size of the source.
+class ProgramCache
+{
+public:
+    static constexpr std::uint32_t Magic = 0x43444d44; // "DMDC"
+    static constexpr std::uint32_t Version = 2;
+
+    // The CFG must be built from the flat AST, its operations refer to the
+    // nodes by NodeId.
+    static std::string serialize(const FlatAST& ast, const CFG& cfg);
+    static bool write(std::string_view path, const FlatAST& ast, const CFG& cfg);
+
+    // Returns an empty optional when the image is malformed or was written
+    // by a different version. The loaded program views the image, so it
+    // must outlive the program. The image must be 8-byte aligned, as mapped
+    // files and allocated strings are.
+    static std::optional<CachedProgram> deserialize(std::string_view image);
+    // The loaded program keeps the file.
+    static std::optional<CachedProgram> load(SourceFile file);
+    static std::optional<CachedProgram> load(std::string_view path);
+};
+
+#endif // CACHE_H
@@ -2,20 +2,148 @@
 #define ANALYSIS_H
 
 #include "include/ast.h"
+#include "include/flat_ast.h"
 
 #include <algorithm>
+#include <array>
+#include <bit>
 #include <cassert>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
 #include <queue>
 #include <ranges>
+#include <span>
 #include <sstream>
 #include <stack>
+#include <utility>
 
-// Elements of a basic block, cannot represent control flow.
-using Operation = std::variant<const Init*, const Translation*, const Rotation*>;
+// The immediates of the operations, copied out of the AST nodes.
+struct InitOp
+{
+    int topX, topY;
+    int width, height;
+};
+
+struct TranslationOp
+{
+    int x, y;
+};
+
+struct RotationOp
+{
+    int x, y, deg;
+};
+
+// Elements of a basic block, cannot represent control flow. The immediates
+// are stored inline, so the analyses do not read the AST. The node is only
+// kept for the annotations. The operations of a CFG built from a FlatAST
+// refer to the node by its NodeId instead of a pointer, so they can be
+// stored in a cache file as they are, and the CFG resolves the node.
+class Operation
+{
+public:
+    enum class Kind : std::uint8_t { Init, Translation, Rotation };
+
+    Operation() = default;
+    Operation(const Init* init) noexcept
+        : args{init->topX, init->topY, init->width, init->height}, nodeAndKind(tag(init, Kind::Init)) {}
+    Operation(const Translation* t) noexcept : args{t->x, t->y, 0, 0}, nodeAndKind(tag(t, Kind::Translation)) {}
+    Operation(const Rotation* r) noexcept : args{r->x, r->y, r->deg, 0}, nodeAndKind(tag(r, Kind::Rotation)) {}
+    template<typename T>
+    Operation(const T* node, NodeId id) noexcept : Operation(node)
+    {
+        assert(static_cast<int>(id.kind()) == static_cast<int>(getKind()));
+        nodeAndKind = IdTag | (std::uint64_t{id.toRaw()} << IdShift) | (nodeAndKind & KindMask);
+    }
+
+    Kind getKind() const noexcept { return static_cast<Kind>(nodeAndKind & KindMask); }
+    bool hasNodeId() const noexcept { return (nodeAndKind & IdTag) != 0; }
+    NodeId getNodeId() const noexcept
+    {
+        assert(hasNodeId());
+        return NodeId::fromRaw(static_cast<std::uint32_t>((nodeAndKind & ~IdTag) >> IdShift));
+    }
+
+    // Calls the visitor with the InitOp, TranslationOp or RotationOp.
+    template<typename Visitor>
+    decltype(auto) visit(Visitor&& visitor) const
+    {
+        switch (getKind())
+        {
+        case Kind::Init:
+            return visitor(InitOp{args[0], args[1], args[2], args[3]});
+        case Kind::Translation:
+            return visitor(TranslationOp{args[0], args[1]});
+        case Kind::Rotation:
+            break;
+        }
+        return visitor(RotationOp{args[0], args[1], args[2]});
+    }
+
+    // The immediates when the operation is a T, similar to std::get_if.
+    template<typename T>
+    std::optional<T> getIf() const noexcept
+    {
+        return visit([](auto op) -> std::optional<T> {
+            if constexpr (std::is_same_v<decltype(op), T>)
+                return op;
+            else
+                return std::nullopt;
+        });
+    }
+
+    // Only for the operations without a NodeId, see CFG::getNode.
+    Node toNode() const noexcept
+    {
+        assert(!hasNodeId());
+        const auto node = static_cast<std::uintptr_t>(nodeAndKind & ~KindMask);
+        switch (getKind())
+        {
+        case Kind::Init:
+            return reinterpret_cast<const Init*>(node);
+        case Kind::Translation:
+            return reinterpret_cast<const Translation*>(node);
+        case Kind::Rotation:
+            break;
+        }
+        return reinterpret_cast<const Rotation*>(node);
+    }
+
+    bool operator==(const Operation& other) const noexcept { return nodeAndKind == other.nodeAndKind; }
+    // The same kind and immediates, the operations can be from different ASTs.
+    bool isEquivalent(const Operation& other) const noexcept
+    {
+        return getKind() == other.getKind() && args == other.args;
+    }
+
+private:
+    // The nodes are at least 4-byte aligned, the kind is kept in the low
+    // bits of the pointer. The top bit, never set in a user-space pointer,
+    // marks a NodeId kept above the kind instead of the pointer.
+    static constexpr std::uint64_t KindMask = 3;
+    static constexpr std::uint64_t IdTag = std::uint64_t{1} << 63;
+    static constexpr unsigned IdShift = 2;
+    template<typename T>
+    static std::uint64_t tag(const T* node, Kind kind) noexcept
+    {
+        static_assert(alignof(T) > KindMask);
+        return reinterpret_cast<std::uintptr_t>(node) | static_cast<std::uintptr_t>(kind);
+    }
+
+    std::array<int, 4> args{};
+    std::uint64_t nodeAndKind = 0;
+};
+
+static_assert(sizeof(Operation) <= 24);
+static_assert(static_cast<int>(NodeKind::Init) == static_cast<int>(Operation::Kind::Init) &&
+              static_cast<int>(NodeKind::Translation) == static_cast<int>(Operation::Kind::Translation) &&
+              static_cast<int>(NodeKind::Rotation) == static_cast<int>(Operation::Kind::Rotation));
 
 inline Node toNode(Operation op) noexcept
 {
-    return std::visit([](const auto* node) noexcept -> Node { return node; }, op);
+    return op.toNode();
 }
 
 template<typename T>
@@ -33,41 +161,275 @@ concept CfgConcept = requires(T a)
     { *a.blocks().begin() } -> CfgBlockConcept;
 };
 
+// A view of a block in a CFG, the operations and the edges of all the blocks
+// are stored contiguously in the CFG.
 class BasicBlock
 {
 public:
-    const std::vector<Operation>& operations() const noexcept { return ops; }
-    const std::vector<int>& successors() const noexcept { return succs; }
-    const std::vector<int>& predecessors() const noexcept { return preds; }
+    std::span<const Operation> operations() const noexcept { return ops; }
+    std::span<const int> successors() const noexcept { return succs; }
+    std::span<const int> predecessors() const noexcept { return preds; }
 
 private:
-    std::vector<Operation> ops;
-    std::vector<int> succs;
-    std::vector<int> preds;
+    std::span<const Operation> ops;
+    std::span<const int> succs;
+    std::span<const int> preds;
     friend class CFG;
 };
 
 static_assert(CfgBlockConcept<BasicBlock>);
 
+// The depth first search of a CFG from its start block. The CFG and the
+// ReverseCFG compute it once and keep it, it is immutable.
+class DfsTree
+{
+public:
+    DfsTree() = default;
+    template<CfgConcept CFG>
+    explicit DfsTree(const CFG& cfg);
+
+    // The unreachable blocks come after the reachable ones in the order of
+    // their ids, their positions are at least rpoBlocks().size().
+    int rpoPosition(int block) const noexcept { return rpoOrder[block]; }
+    // -1 for the unreachable blocks.
+    int preorderPosition(int block) const noexcept { return preorder[block]; }
+    bool isReachable(int block) const noexcept { return preorder[block] >= 0; }
+    // The reachable blocks in reverse post-order.
+    std::span<const int> rpoBlocks() const noexcept { return blocksInRpo; }
+    // The parent of a block in the DFS tree, -1 for the start block.
+    int parent(int block) const noexcept { return parents[block]; }
+    // The target of a back edge is an ancestor of the source in the DFS
+    // tree, or the source itself.
+    bool isBackEdge(int from, int to) const noexcept
+    {
+        return preorder[to] >= 0 && preorder[to] <= preorder[from] && rpoOrder[to] <= rpoOrder[from];
+    }
+    std::span<const std::pair<int, int>> backEdges() const noexcept { return backEdgeList; }
+    // The targets of the back edges.
+    bool isLoopHeader(int block) const noexcept { return loopHeaders[block]; }
+
+private:
+    // A DfsTree loaded from a cache file views the arrays in the file.
+    MappableVector<int> rpoOrder;
+    MappableVector<int> blocksInRpo;
+    MappableVector<int> preorder;
+    MappableVector<int> parents;
+    MappableVector<std::pair<int, int>> backEdgeList;
+    MappableVector<std::uint8_t> loopHeaders;
+
+    friend class ProgramCache;
+};
+
+// The dominator tree of the blocks reachable from the start block, computed
+// with the algorithm of Cooper, Harvey and Kennedy in reverse post-order.
+class DominatorTree
+{
+public:
+    DominatorTree() = default;
+    template<CfgConcept CFG>
+    explicit DominatorTree(const CFG& cfg);
+
+    // The immediate dominator, -1 for the root and the unreachable blocks.
+    int idom(int block) const noexcept { return idoms[block]; }
+    // Every reachable block dominates itself.
+    bool dominates(int dominator, int block) const noexcept
+    {
+        return enter[dominator] >= 0 && enter[dominator] <= enter[block] && exit[block] <= exit[dominator];
+    }
+    // The blocks immediately dominated by the block.
+    std::span<const int> children(int block) const noexcept
+    {
+        return std::span<const int>(childIds).subspan(childStarts[block], childStarts[block + 1] - childStarts[block]);
+    }
+
+private:
+    // The same tree with the blocks numbered as in the reverse of the CFG.
+    DominatorTree mirrored() const;
+    // Computes the children and the numbering of the tree from the idoms.
+    void buildTree();
+
+    int root = 0;
+    std::vector<int> idoms;
+    std::vector<int> childStarts;
+    std::vector<int> childIds;
+    // Entry and exit numbers of the blocks in a DFS of the tree.
+    std::vector<int> enter;
+    std::vector<int> exit;
+
+    friend class CFG;
+    friend class ReverseCFG;
+};
+
+// The loop-nesting forest of a CFG from Havlak's algorithm. Every cycle is in
+// a loop identified by its header, irreducible loops have more entries than
+// the header.
+class LoopForest
+{
+public:
+    LoopForest() = default;
+    template<CfgConcept CFG>
+    explicit LoopForest(const CFG& cfg);
+
+    bool isHeader(int block) const noexcept { return kinds[block] != Kind::None; }
+    bool isIrreducible(int header) const noexcept { return kinds[header] == Kind::Irreducible; }
+    // The header of the innermost loop containing the block, a header is in
+    // its own loop. -1 outside of loops.
+    int loopOf(int block) const noexcept { return isHeader(block) ? block : parents[block]; }
+    // The header of the innermost loop containing the block or the loop of
+    // the header. -1 at the top level.
+    int parent(int block) const noexcept { return parents[block]; }
+    // The number of loops containing the block.
+    int depth(int block) const noexcept { return depths[block]; }
+    // The headers, enclosing loops precede the nested ones.
+    std::span<const int> headers() const noexcept { return headerIds; }
+
+private:
+    enum class Kind : std::uint8_t { None, Reducible, Irreducible };
+    std::vector<Kind> kinds;
+    std::vector<int> parents;
+    std::vector<int> depths;
+    std::vector<int> headerIds;
+};
+
+// A value computed on the first use and kept afterwards, it is safe to use
+// from multiple threads. Copies share the value.
+template<typename T>
+class LazyValue
+{
+public:
+    template<typename Compute>
+    const T& get(Compute compute) const
+    {
+        std::call_once(state->once, [&] { state->value.emplace(compute()); });
+        return *state->value;
+    }
+
+private:
+    struct State
+    {
+        std::once_flag once;
+        std::optional<T> value;
+    };
+    std::shared_ptr<State> state = std::make_shared<State>();
+};
+
+struct SimplifiedCFG;
+
+// The CFG is immutable once built. The operations, the successors and
+// the predecessors of the blocks are stored in compressed sparse row
+// format: each of them is a single array where the entries of a block
+// are a contiguous range, the blocks only store their ranges.
 class CFG
 {
 public:
     // The first block is the start block. The last block is the end block.
-    const std::vector<BasicBlock>& blocks() const { return basicBlocks; }
+    std::span<const BasicBlock> blocks() const noexcept { return basicBlocks; }
     static CFG createCfg(Node root) noexcept;
+    // The operations point into the arrays of the FlatAST.
+    static CFG createCfg(const FlatAST& ast) noexcept;
+    // Removes the empty blocks and merges the straight-line chains of blocks.
+    // The start block remains the first and the end block the last block.
+    SimplifiedCFG simplify() const;
+    // The node of an operation of the CFG.
+    Node getNode(Operation op) const noexcept;
+    const DfsTree& dfsTree() const noexcept { return dfs; }
+    // Computed on the first use.
+    const DominatorTree& dominators() const;
+    const DominatorTree& postDominators() const;
+    const LoopForest& loops() const;
+
+    CFG(CFG&&) = default;
+    CFG& operator=(CFG&&) = default;
+    // The blocks point into the arrays of the CFG.
+    CFG(const CFG&) = delete;
+    CFG& operator=(const CFG&) = delete;
 
 private:
+    // Every block has its own vectors, used when rewriting a CFG.
+    struct Builder
+    {
+        struct Block
+        {
+            std::vector<Operation> ops;
+            std::vector<int> succs;
+            std::vector<int> preds;
+        };
+
+        Builder& addEdge(int from, int to);
+        int newBlock();
+        // Copies the blocks into the contiguous arrays.
+        CFG freeze() const;
+
+        std::vector<Block> blocks;
+    };
+
+    struct BlockSizes
+    {
+        std::uint32_t ops;
+        std::uint32_t succs;
+        std::uint32_t preds;
+    };
+
+    // createCfg walks the AST twice. The first pass counts the operations
+    // and the edges of every block, the second writes them into the arrays
+    // presized from the counts.
+    struct SizeCounter;
+    struct Filler;
+    template<typename Tree>
+    static CFG createCfg(const Tree& tree, typename Tree::NodeRef root) noexcept;
+
     CFG() = default;
+    // The blocks in reverse order with reversed edges and operations.
+    CFG reversed() const;
+    // Points the blocks into the arrays, the ranges of the blocks follow
+    // each other in block order. Also computes the DFS tree unless it is
+    // given.
+    void setBlockRanges(std::span<const BlockSizes> sizes, std::optional<DfsTree> dfsTree = {});
+
+    // The operation nodes of the FlatAST the CFG was built from, the
+    // operations refer to them by NodeId.
+    struct FlatNodes
+    {
+        std::span<const Init> inits;
+        std::span<const Translation> translations;
+        std::span<const Rotation> rotations;
+    };
+
     std::vector<BasicBlock> basicBlocks;
-    CFG& addEdge(int from, int to);
-    int newBlock();
-    int addAstNode(int currentBlock, Node currentNode);
+    // A CFG loaded from a cache file views the arrays in the file.
+    MappableVector<Operation> operations;
+    MappableVector<int> successorIds;
+    MappableVector<int> predecessorIds;
+    FlatNodes flatNodes;
+    DfsTree dfs;
+    LazyValue<DominatorTree> dominatorTree;
+    LazyValue<DominatorTree> postDominatorTree;
+    LazyValue<LoopForest> loopForest;
 
     friend class CFGTest;
+    friend class ProgramCache;
+    friend class MaterializedReverseCFG;
 };
 
 static_assert(CfgConcept<CFG>);
 
+// The state at the end of a block of the original CFG is the state after the
+// first `operations` operations of `block` in the simplified CFG.
+struct BlockLocation
+{
+    int block;
+    int operations;
+};
+
+struct SimplifiedCFG
+{
+    CFG cfg;
+    // Indexed by the block ids of the original CFG. A removed empty block with
+    // a single successor is located at the start of its successor, the state
+    // there can be less precise when the successor has other predecessors.
+    std::vector<BlockLocation> originalBlocks;
+};
+
 class ReverseBasicBlock
 {
 public:
@@ -96,7 +458,7 @@ static_assert(CfgBlockConcept<ReverseBasicBlock>);
 class ReverseCFG
 {
 public:
-    ReverseCFG(const CFG& cfg) : cfg(cfg) {}
+    ReverseCFG(const CFG& cfg);
 
     auto blocks() const {
         return std::views::reverse(cfg.blocks()) |
@@ -104,28 +466,88 @@ public:
                   return ReverseBasicBlock(bb, size);
                });
     }
+    const DfsTree& dfsTree() const noexcept { return dfs; }
+    Node getNode(Operation op) const noexcept { return cfg.getNode(op); }
+    // Computed on the first use, the post-dominators are the dominators of
+    // the CFG.
+    const DominatorTree& dominators() const;
+    const DominatorTree& postDominators() const;
+    const LoopForest& loops() const;
 
 private:
     const CFG& cfg;
+    DfsTree dfs; // Must be declared after the CFG.
+    LazyValue<DominatorTree> dominatorTree;
+    LazyValue<DominatorTree> postDominatorTree;
+    LazyValue<LoopForest> loopForest;
 };
 
 static_assert(CfgConcept<ReverseCFG>);
 
+inline ReverseCFG::ReverseCFG(const CFG& cfg) : cfg(cfg), dfs(*this) {}
+
+// The blocks of a ReverseCFG copied into contiguous arrays once. The edges
+// are read directly instead of being mapped on every access.
+class MaterializedReverseCFG
+{
+public:
+    explicit MaterializedReverseCFG(const CFG& cfg) : reversedCfg(cfg.reversed()) {}
+
+    std::span<const BasicBlock> blocks() const noexcept { return reversedCfg.blocks(); }
+    const DfsTree& dfsTree() const noexcept { return reversedCfg.dfsTree(); }
+    Node getNode(Operation op) const noexcept { return reversedCfg.getNode(op); }
+    const DominatorTree& dominators() const { return reversedCfg.dominators(); }
+    const DominatorTree& postDominators() const { return reversedCfg.postDominators(); }
+    const LoopForest& loops() const { return reversedCfg.loops(); }
+
+private:
+    CFG reversedCfg;
+};
+
+static_assert(CfgConcept<MaterializedReverseCFG>);
+
+// The operations of the blocks are in reverse order.
+template<typename CFG>
+constexpr bool IsReverseCfg = std::is_same_v<CFG, ReverseCFG> || std::is_same_v<CFG, MaterializedReverseCFG>;
+
+// The node of an operation of the CFG. Only the CFGs that can be built from
+// a FlatAST resolve the NodeIds of the operations.
+template<CfgConcept CFG>
+Node getNode(const CFG& cfg, Operation op) noexcept
+{
+    if constexpr (requires { { cfg.getNode(op) } -> std::same_as<Node>; })
+        return cfg.getNode(op);
+    else
+        return toNode(op);
+}
+
+// The depth first search of the CFG if it keeps one, otherwise a new one
+// created in `storage`.
 template<CfgConcept CFG>
+const DfsTree& getDfsTree(const CFG& cfg, std::optional<DfsTree>& storage)
+{
+    if constexpr (requires { { cfg.dfsTree() } -> std::same_as<const DfsTree&>; })
+        return cfg.dfsTree();
+    else
+        return storage.emplace(cfg);
+}
+
 class RPOCompare
 {
 public:
-    explicit RPOCompare(const CFG& cfg);
+    explicit RPOCompare(const DfsTree& dfs) : dfs(&dfs) {}
+    template<CfgConcept CFG>
+    explicit RPOCompare(const CFG& cfg) : dfs(&cfg.dfsTree()) {}
 
     bool operator()(int lhsBlockId, int rhsBlockId) const
     {
         // std::priority_queue is a max-heap by default.
-        return rpoOrder[lhsBlockId] > rpoOrder[rhsBlockId];
+        return dfs->rpoPosition(lhsBlockId) > dfs->rpoPosition(rhsBlockId);
     }
 
-    int getRpoPosition(int node) const { return rpoOrder[node]; }
+    int getRpoPosition(int node) const { return dfs->rpoPosition(node); }
 private:
-    std::vector<int> rpoOrder;
+    const DfsTree* dfs;
 };
 
 template<CfgConcept CFG>
@@ -138,82 +560,119 @@ public:
     int dequeue() noexcept;
     bool empty() const noexcept { return worklist.empty(); }
 private:
-    using Worklist = std::priority_queue<int, std::vector<int>, RPOCompare<CFG>>;
+    using Worklist = std::priority_queue<int, std::vector<int>, RPOCompare>;
     const CFG& cfg;
-    RPOCompare<CFG> comparator; // Must be declared before the worklist.
+    std::optional<DfsTree> uncachedDfs; // Only for CFGs without a DFS tree.
+    RPOCompare comparator; // Must be declared before the worklist.
     Worklist worklist;
     std::vector<bool> queued;
 };
 
+// Dequeues the same blocks in the same order as RPOWorklist. The pending
+// blocks are bits of a bitset indexed by RPO position, dequeue scans for
+// the lowest set bit starting at the lowest word that can be non-zero.
 template<CfgConcept CFG>
-std::string print(const CFG& cfg) noexcept
+class BitsetRPOWorklist
 {
-    std::stringstream out;
-    out << "digraph CFG {\n";
-    int counter = 0;
-    for (const auto& block : cfg.blocks())
-    {
-        out << "  Node_" << counter << R"([label=")";
-        for (auto op : block.operations())
-            out << print(toNode(op)) << R"(\n)";
-
-        out << "\"]\n";
-        ++counter;
-    }
-    out << '\n';
-    counter = 0;
-    for (const auto& block : cfg.blocks())
-    {
-        for (auto next : block.successors())
-            out << "  Node_" << counter << " -> " << "Node_" << next << "\n";
-
-        ++counter;
-    }
-    out << "}\n";
-    return std::move(out).str();
-}
+public:
+    explicit BitsetRPOWorklist(const CFG&);
+    void enqueue(int node) noexcept;
+    void enqueueSuccessors(int node) noexcept;
+    int dequeue() noexcept;
+    bool empty() const noexcept { return pending == 0; }
+private:
+    static constexpr int WordBits = 64;
+    const CFG& cfg;
+    std::optional<DfsTree> uncachedDfs; // Only for CFGs without a DFS tree.
+    const DfsTree& dfs;
+    std::vector<std::uint64_t> words;
+    std::size_t cursor = 0;
+    std::size_t pending = 0;
+};
 
 template<CfgConcept CFG>
-RPOCompare<CFG>::RPOCompare(const CFG& cfg)  : rpoOrder(cfg.blocks().size())
+DfsTree::DfsTree(const CFG& cfg)
 {
     enum class Color { White, Gray, Black };
+    struct Visit
+    {
+        int block;
+        int parent;
+    };
+    const std::size_t blockCount = cfg.blocks().size();
+    std::vector<int> rpo(blockCount);
+    std::vector<int> pre(blockCount, -1);
+    std::vector<int> parentIds(blockCount, -1);
     int counter = 0;
-    std::stack<int, std::vector<int>> stack;
-    std::vector<Color> state(cfg.blocks().size(), Color::White);
-    stack.push(0);
+    int preorderCounter = 0;
+    std::stack<Visit, std::vector<Visit>> stack;
+    std::vector<Color> state(blockCount, Color::White);
+    stack.push({0, -1});
     while(!stack.empty())
     {
-        int current = stack.top();
+        auto [current, parent] = stack.top();
         stack.pop();
         switch(state[current])
         {
             case Color::White:
             {
                 state[current] = Color::Gray;
-                stack.push(current);
+                pre[current] = preorderCounter++;
+                parentIds[current] = parent;
+                stack.push({current, parent});
                 for(auto succ : cfg.blocks()[current].successors())
                 {
                     if (state[succ] == Color::White)
-                        stack.push(succ);
+                        stack.push({succ, current});
                 }
                 break;
             }
             case Color::Gray:
                 state[current] = Color::Black;
-                rpoOrder[current] = counter++;
+                rpo[current] = counter++;
                 break;
             case Color::Black:
                 break;
         }
     }
     const auto maxPos = counter - 1;
-    for (unsigned node = 0; node < rpoOrder.size(); ++node)
-        rpoOrder[node] = maxPos - rpoOrder[node];
+    std::vector<int> inRpo(counter);
+    for (unsigned node = 0; node < rpo.size(); ++node)
+    {
+        if (pre[node] >= 0)
+        {
+            rpo[node] = maxPos - rpo[node];
+            inRpo[rpo[node]] = node;
+        }
+        else
+            rpo[node] = counter++;
+    }
+    rpoOrder = std::move(rpo);
+    blocksInRpo = std::move(inRpo);
+    preorder = std::move(pre);
+    parents = std::move(parentIds);
+
+    std::vector<std::pair<int, int>> edges;
+    std::vector<std::uint8_t> headers(blockCount, false);
+    for (int node : blocksInRpo)
+    {
+        for (auto succ : cfg.blocks()[node].successors())
+        {
+            if (isBackEdge(node, succ))
+            {
+                edges.emplace_back(node, succ);
+                headers[succ] = true;
+            }
+        }
+    }
+    backEdgeList = std::move(edges);
+    loopHeaders = std::move(headers);
 }
 
 template<CfgConcept CFG>
 RPOWorklist<CFG>::RPOWorklist(const CFG& cfg)
-  : cfg(cfg), comparator(cfg), worklist(comparator), queued(cfg.blocks().size(), false) {}
+  : cfg(cfg), comparator(getDfsTree(cfg, uncachedDfs)), worklist(comparator),
+    queued(cfg.blocks().size(), false) {}
 
 template<CfgConcept CFG>
 void RPOWorklist<CFG>::enqueue(int node) noexcept
@@ -242,4 +701,187 @@ int RPOWorklist<CFG>::dequeue() noexcept
     return node;
 }
 
-#endif // ANALYSIS_H
\ No newline at end of file
+template<CfgConcept CFG>
+BitsetRPOWorklist<CFG>::BitsetRPOWorklist(const CFG& cfg)
+  : cfg(cfg), dfs(getDfsTree(cfg, uncachedDfs)),
+    words((dfs.rpoBlocks().size() + WordBits - 1) / WordBits, 0) {}
+
+template<CfgConcept CFG>
+void BitsetRPOWorklist<CFG>::enqueue(int node) noexcept
+{
+    assert(dfs.isReachable(node));
+    const std::size_t position = dfs.rpoPosition(node);
+    const std::size_t word = position / WordBits;
+    const std::uint64_t bit = std::uint64_t{1} << (position % WordBits);
+    if (words[word] & bit)
+        return;
+
+    words[word] |= bit;
+    cursor = std::min(cursor, word);
+    ++pending;
+}
+
+template<CfgConcept CFG>
+void BitsetRPOWorklist<CFG>::enqueueSuccessors(int node) noexcept
+{
+    for (int succ : cfg.blocks()[node].successors())
+        enqueue(succ);
+}
+
+template<CfgConcept CFG>
+int BitsetRPOWorklist<CFG>::dequeue() noexcept
+{
+    assert(pending > 0);
+    while (words[cursor] == 0)
+        ++cursor;
+    const int bit = std::countr_zero(words[cursor]);
+    words[cursor] &= words[cursor] - 1;
+    --pending;
+    return dfs.rpoBlocks()[cursor * WordBits + bit];
+}
+
+template<CfgConcept CFG>
+DominatorTree::DominatorTree(const CFG& cfg)
+  : idoms(cfg.blocks().size(), -1)
+{
+    std::optional<DfsTree> uncachedDfs;
+    const DfsTree& dfs = getDfsTree(cfg, uncachedDfs);
+    auto intersect = [&](int lhs, int rhs) {
+        while (lhs != rhs)
+        {
+            while (dfs.rpoPosition(lhs) > dfs.rpoPosition(rhs))
+                lhs = idoms[lhs];
+            while (dfs.rpoPosition(rhs) > dfs.rpoPosition(lhs))
+                rhs = idoms[rhs];
+        }
+        return lhs;
+    };
+
+    // The root is its own idom during the iteration.
+    idoms[0] = 0;
+    bool changed = true;
+    while (changed)
+    {
+        changed = false;
+        for (int block : dfs.rpoBlocks().subspan(1))
+        {
+            int newIdom = -1;
+            for (auto pred : cfg.blocks()[block].predecessors())
+            {
+                if (idoms[pred] < 0)
+                    continue;
+                newIdom = newIdom < 0 ? pred : intersect(pred, newIdom);
+            }
+            if (newIdom != idoms[block])
+            {
+                idoms[block] = newIdom;
+                changed = true;
+            }
+        }
+    }
+    idoms[0] = -1;
+    buildTree();
+}
+
+// Havlak's algorithm, the union-find keeps the chains of loops short and
+// the running time near-linear.
+template<CfgConcept CFG>
+LoopForest::LoopForest(const CFG& cfg)
+  : kinds(cfg.blocks().size(), Kind::None), parents(cfg.blocks().size(), -1),
+    depths(cfg.blocks().size(), 0)
+{
+    std::optional<DfsTree> uncachedDfs;
+    const DfsTree& dfs = getDfsTree(cfg, uncachedDfs);
+    const std::size_t blockCount = cfg.blocks().size();
+    std::vector<int> inPreorder(dfs.rpoBlocks().size());
+    for (int block : dfs.rpoBlocks())
+        inPreorder[dfs.preorderPosition(block)] = block;
+
+    // The union-find of the blocks collapsed into the loops found so far.
+    std::vector<int> representatives(blockCount);
+    for (std::size_t block = 0; block < blockCount; ++block)
+        representatives[block] = block;
+    auto find = [&](int block) {
+        int root = block;
+        while (representatives[root] != root)
+            root = representatives[root];
+        while (representatives[block] != root)
+            block = std::exchange(representatives[block], root);
+        return root;
+    };
+
+    // The entries into irreducible loops become the non-back predecessors of
+    // their headers.
+    std::vector<std::vector<int>> extraPreds(blockCount);
+    std::vector<int> inLoopOf(blockCount, -1);
+    std::vector<int> body;
+    std::vector<int> worklist;
+    for (int header : std::views::reverse(inPreorder))
+    {
+        body.clear();
+        bool selfLoop = false;
+        for (auto pred : cfg.blocks()[header].predecessors())
+        {
+            if (!dfs.isBackEdge(pred, header))
+                continue;
+            if (pred == header)
+            {
+                selfLoop = true;
+                continue;
+            }
+            int member = find(pred);
+            if (inLoopOf[member] != header)
+            {
+                inLoopOf[member] = header;
+                body.push_back(member);
+            }
+        }
+        if (body.empty() && !selfLoop)
+            continue;
+
+        kinds[header] = Kind::Reducible;
+        worklist = body;
+        while (!worklist.empty())
+        {
+            int member = worklist.back();
+            worklist.pop_back();
+            auto visitPred = [&](int pred) {
+                if (!dfs.isReachable(pred) || dfs.isBackEdge(pred, member))
+                    return;
+                int predMember = find(pred);
+                if (!dfs.isBackEdge(predMember, header))
+                {
+                    // Enters the loop avoiding the header.
+                    kinds[header] = Kind::Irreducible;
+                    extraPreds[header].push_back(predMember);
+                }
+                else if (predMember != header && inLoopOf[predMember] != header)
+                {
+                    inLoopOf[predMember] = header;
+                    body.push_back(predMember);
+                    worklist.push_back(predMember);
+                }
+            };
+            for (auto pred : cfg.blocks()[member].predecessors())
+                visitPred(pred);
+            for (std::size_t i = 0; i < extraPreds[member].size(); ++i)
+                visitPred(extraPreds[member][i]);
+        }
+        for (int member : body)
+        {
+            parents[member] = header;
+            representatives[member] = header;
+        }
+    }
+
+    // The enclosing loops are ancestors in the DFS tree.
+    for (int block : inPreorder)
+    {
+        const int enclosing = parents[block] < 0 ? 0 : depths[parents[block]];
+        depths[block] = enclosing + (isHeader(block) ? 1 : 0);
+        if (isHeader(block))
+            headerIds.push_back(block);
+    }
+}
+
+#endif // ANALYSIS_H
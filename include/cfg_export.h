@@ -0,0 +1,169 @@
+#ifndef CFG_EXPORT_H
+#define CFG_EXPORT_H
+
+#include <cstdint>
+#include <iterator>
+#include <optional>
+#include <ostream>
+#include <ranges>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include <fmt/format.h>
+
+#include "include/cfg.h"
+
+// Collects the output in a buffer and writes it to a file descriptor or to
+// a stream whenever the buffer fills up, so the size of the exported graph
+// does not affect the memory usage.
+class BufferedWriter
+{
+public:
+    explicit BufferedWriter(int fd) noexcept : fd(fd) {}
+    explicit BufferedWriter(std::ostream& out) noexcept : out(&out) {}
+    ~BufferedWriter() { flush(); }
+    BufferedWriter(const BufferedWriter&) = delete;
+    BufferedWriter& operator=(const BufferedWriter&) = delete;
+
+    template<typename... Args>
+    void print(fmt::format_string<Args...> format, Args&&... args)
+    {
+        fmt::format_to(std::back_inserter(buffer), format, std::forward<Args>(args)...);
+        flushIfFull();
+    }
+    void write(std::string_view bytes)
+    {
+        buffer.append(bytes);
+        flushIfFull();
+    }
+    void writeWord(std::uint32_t word)
+    {
+        write(std::string_view(reinterpret_cast<const char*>(&word), sizeof(word)));
+    }
+    void flush() noexcept;
+    // False when writing any of the output failed.
+    bool ok() const noexcept { return !failed; }
+
+private:
+    static constexpr std::size_t FlushSize = 64 * 1024;
+    void flushIfFull()
+    {
+        if (buffer.size() >= FlushSize)
+            flush();
+    }
+
+    fmt::memory_buffer buffer;
+    int fd = -1;
+    std::ostream* out = nullptr;
+    bool failed = false;
+};
+
+// Dot: Graphviz, the labels of the nodes list the operations.
+// Json: {"blocks": [{"id": 0, "operations": [...], "successors": [...]}, ...]}.
+// EdgeList: 32-bit words in native byte order, the magic, the version, the
+// number of blocks and the number of edges followed by the (from, to) pairs.
+enum class CfgFormat { Dot, Json, EdgeList };
+
+inline constexpr std::uint32_t EdgeListMagic = 0x45444d44; // "DMDE"
+inline constexpr std::uint32_t EdgeListVersion = 1;
+
+// Accepts "dot", "json" and "edges".
+std::optional<CfgFormat> parseCfgFormat(std::string_view name) noexcept;
+
+// Writes the same text as print(toNode(op)) from the immediates.
+void writeOperation(BufferedWriter& out, Operation op);
+
+template<CfgConcept CFG>
+void exportCfg(const CFG& cfg, CfgFormat format, BufferedWriter& out)
+{
+    switch (format)
+    {
+    case CfgFormat::Dot:
+    {
+        out.write("digraph CFG {\n");
+        int counter = 0;
+        for (const auto& block : cfg.blocks())
+        {
+            out.print("  Node_{}[label=\"", counter++);
+            for (auto op : block.operations())
+            {
+                writeOperation(out, op);
+                out.write(R"(\n)");
+            }
+            out.write("\"]\n");
+        }
+        out.write("\n");
+        counter = 0;
+        for (const auto& block : cfg.blocks())
+        {
+            for (auto next : block.successors())
+                out.print("  Node_{} -> Node_{}\n", counter, next);
+            ++counter;
+        }
+        out.write("}\n");
+        return;
+    }
+    case CfgFormat::Json:
+    {
+        // The operations contain no characters that need escaping.
+        out.write("{\"blocks\": [");
+        int counter = 0;
+        for (const auto& block : cfg.blocks())
+        {
+            out.print("{}\n  {{\"id\": {}, \"operations\": [", counter > 0 ? "," : "", counter);
+            const char* separator = "";
+            for (auto op : block.operations())
+            {
+                out.print("{}\"", std::exchange(separator, ", "));
+                writeOperation(out, op);
+                out.write("\"");
+            }
+            out.write("], \"successors\": [");
+            separator = "";
+            for (auto next : block.successors())
+                out.print("{}{}", std::exchange(separator, ", "), next);
+            out.write("]}");
+            ++counter;
+        }
+        out.write("\n]}\n");
+        return;
+    }
+    case CfgFormat::EdgeList:
+    {
+        std::size_t edges = 0;
+        for (const auto& block : cfg.blocks())
+            edges += std::ranges::distance(block.successors());
+        out.writeWord(EdgeListMagic);
+        out.writeWord(EdgeListVersion);
+        out.writeWord(static_cast<std::uint32_t>(std::ranges::distance(cfg.blocks())));
+        out.writeWord(static_cast<std::uint32_t>(edges));
+        std::uint32_t counter = 0;
+        for (const auto& block : cfg.blocks())
+        {
+            for (auto next : block.successors())
+            {
+                out.writeWord(counter);
+                out.writeWord(static_cast<std::uint32_t>(next));
+            }
+            ++counter;
+        }
+        return;
+    }
+    }
+}
+
+// The CFG in the Dot format.
+template<CfgConcept CFG>
+std::string print(const CFG& cfg)
+{
+    std::ostringstream out;
+    {
+        BufferedWriter writer(out);
+        exportCfg(cfg, CfgFormat::Dot, writer);
+    }
+    return std::move(out).str();
+}
+
+#endif // CFG_EXPORT_H
@@ -21,6 +21,15 @@ std::vector<Vec2Interval> getPrimitiveIntervalAnalysis(const CFG& cfg);
 // Always widen during the fixed-point iteration.
 std::vector<Vec2Interval> getIntervalAnalysis(const CFG& cfg);
 
+// Widen, then narrow the result in a bounded descending iteration.
+std::vector<Vec2Interval> getNarrowedIntervalAnalysis(const CFG& cfg);
+
+// Only widen at the heads of the components of a weak topological order.
+std::vector<Vec2Interval> getWtoIntervalAnalysis(const CFG& cfg);
+
+// Solve the strongly connected components one at a time in topological order.
+std::vector<Vec2Interval> getSccIntervalAnalysis(const CFG& cfg);
+
 Annotations intervalAnalysisToOperationAnnotations(const CFG& cfg,
                                                    const std::vector<Vec2Interval>& results);
 
@@ -28,9 +37,7 @@ std::vector<Polygon> intervalAnalysisToCoveredArea(const CFG& cfg,
                                                    const std::vector<Vec2Interval>& results);
 
 // TODO: add variants of interval analysis:
-// - Back-edge only widening
 // - Loop unrolling
-// - Narrowing
 // - ...
 
 #endif // INTERVAL_ANALYSIS_H
\ No newline at end of file
@@ -11,17 +11,20 @@ using StringSetDomain = PowersetDomain<std::string>;
 
 struct ReachableOperationsTransfer
 {
-    StringSetDomain operator()(Operation op, const StringSetDomain& preState) const;
+    StringSetDomain operator()(Operation op, StringSetDomain preState) const;
 };
 
 std::vector<StringSetDomain> getPastOperationsAnalysis(const CFG& cfg);
 std::vector<StringSetDomain> getFutureOperationsAnalysis(const ReverseCFG& cfg);
+std::vector<StringSetDomain> getFutureOperationsAnalysis(const MaterializedReverseCFG& cfg);
 
 Annotations pastOperationsAnalysisToOperationAnnotations(const CFG& cfg,
                                                          const std::vector<StringSetDomain>& results);
 
 Annotations futureOperationsAnalysisToOperationAnnotations(const ReverseCFG& cfg,
                                                            const std::vector<StringSetDomain>& results);
+Annotations futureOperationsAnalysisToOperationAnnotations(const MaterializedReverseCFG& cfg,
+                                                           const std::vector<StringSetDomain>& results);
 
 inline std::vector<Polygon> pastOperationsAnalysisToCoveredArea(const CFG&,
     const std::vector<StringSetDomain>&)
@@ -35,4 +38,10 @@ inline std::vector<Polygon> futureOperationsAnalysisToCoveredArea(const ReverseC
     return {};
 }
 
+inline std::vector<Polygon> futureOperationsAnalysisToCoveredArea(const MaterializedReverseCFG&,
+    const std::vector<StringSetDomain>&)
+{
+    return {};
+}
+
 #endif // REACHABLE_OPERATIONS_ANALYSIS_H 
\ No newline at end of file
@@ -4,6 +4,7 @@
 #include <concepts>
 #include <string_view>
 #include <limits>
+#include <utility>
 
 #include "include/utils.h"
 
@@ -45,6 +46,82 @@ concept WidenableDomain = Domain<T> &&
     { a.widen(a) } -> std::same_as<T>; 
 };
 
+// Optional, refines the result of widening in a descending iteration, the
+// infinite bounds are replaced by the ones of the new state.
+template<typename T>
+concept NarrowableDomain = WidenableDomain<T> &&
+    requires(T a)
+{
+    // Requirements:
+    // * b <= a implies b <= a.narrow(b) <= a
+    // * a.narrow(bottom) == bottom
+    // * a.narrow(a) == a
+    { a.narrow(a) } -> std::same_as<T>;
+};
+
+// Optional in-place versions of join and widen. They update the value and
+// return whether it changed, so the solvers do not have to copy or compare
+// whole states.
+// Requirements:
+// * after c = a, changed = a.joinWith(b): a == c.join(b) and changed == !(a == c)
+template<typename T>
+concept InPlaceJoinDomain = Domain<T> &&
+    requires(T a, const T& b)
+{
+    { a.joinWith(b) } -> std::same_as<bool>;
+};
+
+// Requirements:
+// * after c = a, changed = a.widenWith(b): a == c.widen(b) and changed == !(a == c)
+template<typename T>
+concept InPlaceWidenDomain = WidenableDomain<T> &&
+    requires(T a, const T& b)
+{
+    { a.widenWith(b) } -> std::same_as<bool>;
+};
+
+// Joins `other` into `state` and returns whether `state` changed. Falls back
+// to join and a comparison for domains without joinWith.
+template<Domain D>
+bool joinInto(D& state, const D& other)
+{
+    if constexpr (InPlaceJoinDomain<D>)
+        return state.joinWith(other);
+    else
+    {
+        D joined = state.join(other);
+        if (joined == state)
+            return false;
+        state = std::move(joined);
+        return true;
+    }
+}
+
+template<WidenableDomain D>
+bool widenInto(D& state, const D& other)
+{
+    if constexpr (InPlaceWidenDomain<D>)
+        return state.widenWith(other);
+    else
+    {
+        D widened = state.widen(other);
+        if (widened == state)
+            return false;
+        state = std::move(widened);
+        return true;
+    }
+}
+
+template<NarrowableDomain D>
+bool narrowInto(D& state, const D& other)
+{
+    D narrowed = state.narrow(other);
+    if (narrowed == state)
+        return false;
+    state = std::move(narrowed);
+    return true;
+}
+
 // TODO: add helper tools to generate tests about the semantic requirements.
 
 #endif // SOLVER_H
@@ -26,6 +26,14 @@ struct IntervalDomain
         return {std::min(min, other.min), std::max(max, other.max)};
     }
 
+    bool joinWith(IntervalDomain other) noexcept
+    {
+        IntervalDomain old = *this;
+        min = std::min(min, other.min);
+        max = std::max(max, other.max);
+        return min != old.min || max != old.max;
+    }
+
     IntervalDomain widen(IntervalDomain transferredState) const
     {
         if (*this == bottom())
@@ -43,6 +51,22 @@ struct IntervalDomain
         return {resultMin, resultMax};
     }
 
+    bool widenWith(IntervalDomain transferredState) noexcept
+    {
+        IntervalDomain widened = widen(transferredState);
+        const bool changed = widened.min != min || widened.max != max;
+        *this = widened;
+        return changed;
+    }
+
+    IntervalDomain narrow(IntervalDomain transferredState) const
+    {
+        if (transferredState == bottom())
+            return bottom();
+        return {min == NEG_INF ? transferredState.min : min,
+                max == INF ? transferredState.max : max};
+    }
+
     std::string toString() const
     {
         const auto toStr = [](int num) -> std::string {
@@ -71,7 +95,7 @@ inline bool operator<=(IntervalDomain lhs, IntervalDomain rhs) noexcept
     return rhs.min <= lhs.min && rhs.max >= lhs.max;
 }
 
-static_assert(WidenableDomain<IntervalDomain>);
+static_assert(NarrowableDomain<IntervalDomain>);
 
 // TODO: should these handle bottom?
 inline IntervalDomain operator-(IntervalDomain o) noexcept
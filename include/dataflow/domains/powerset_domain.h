@@ -6,6 +6,7 @@
 #include <algorithm>
 #include <initializer_list>
 #include <set>
+#include <utility>
 
 #include "include/dataflow/domains/domain.h"
 
@@ -16,13 +17,20 @@ struct PowersetDomain
     PowersetDomain(std::initializer_list<Element> e) : data{e} {}
     static PowersetDomain bottom() { return {}; }
 
-    PowersetDomain insert(const Element& element) const
+    PowersetDomain insert(const Element& element) const&
     {
         PowersetDomain result{*this};
         result.data.insert(element);
         return result;
     }
 
+    // Reuses the set of a temporary.
+    PowersetDomain insert(const Element& element) &&
+    {
+        data.insert(element);
+        return std::move(*this);
+    }
+
     bool operator==(const PowersetDomain& other) const
     {
         return data == other.data;
@@ -40,6 +48,13 @@ struct PowersetDomain
         return other;
     }
 
+    bool joinWith(const PowersetDomain& other)
+    {
+        const std::size_t size = data.size();
+        data.insert(other.data.begin(), other.data.end());
+        return data.size() != size;
+    }
+
     std::string toString() const
     {
         std::string result{"{"};
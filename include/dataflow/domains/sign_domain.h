@@ -51,6 +51,13 @@ struct SignDomain
         return SignDomain{ Top };
     }
 
+    bool joinWith(SignDomain other) noexcept
+    {
+        const SignValue old = v;
+        v = join(other).v;
+        return v != old;
+    }
+
     std::string_view toString() const
     {
         switch(v)
@@ -39,11 +39,30 @@ struct Vec2Domain
         return Vec2Domain{x.join(other.x), y.join(other.y)};
     }
 
+    bool joinWith(const Vec2Domain& other)
+    {
+        const bool xChanged = joinInto(x, other.x);
+        const bool yChanged = joinInto(y, other.y);
+        return xChanged || yChanged;
+    }
+
     Vec2Domain widen(const Vec2Domain transferredState) const requires WidenableDomain<D>
     {
         return {x.widen(transferredState.x), y.widen(transferredState.y)};
     }
 
+    bool widenWith(const Vec2Domain& transferredState) requires WidenableDomain<D>
+    {
+        const bool xChanged = widenInto(x, transferredState.x);
+        const bool yChanged = widenInto(y, transferredState.y);
+        return xChanged || yChanged;
+    }
+
+    Vec2Domain narrow(const Vec2Domain& transferredState) const requires NarrowableDomain<D>
+    {
+        return {x.narrow(transferredState.x), y.narrow(transferredState.y)};
+    }
+
     std::string toString() const
     {
         return fmt::format("{{ x: {}, y: {} }}", x.toString(), y.toString());
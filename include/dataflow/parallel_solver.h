@@ -0,0 +1,244 @@
+#ifndef PARALLEL_SOLVER_H
+#define PARALLEL_SOLVER_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+#include "include/dataflow/domains/domain.h"
+#include "include/dataflow/transfer.h"
+#include "include/cfg.h"
+
+// Protects the state of a block. The states are only held for a join, so
+// the waiting threads spin instead of sleeping.
+class SpinLock
+{
+public:
+    void lock() noexcept
+    {
+        while (flag.test_and_set(std::memory_order_acquire))
+            std::this_thread::yield();
+    }
+    void unlock() noexcept { flag.clear(std::memory_order_release); }
+
+private:
+    std::atomic_flag flag;
+};
+
+// The blocks waiting to be processed by a pool of workers. Every worker has
+// its own queue ordered by RPO like RPOWorklist, the blocks enqueued by a
+// worker go to its own queue, and an idle worker steals the first block of
+// the queue of another worker.
+//
+// A block is never processed by two workers at the same time. When it is
+// enqueued while it is being processed, it is queued again by `finish`, so
+// the changes of its predecessors are never missed.
+template<CfgConcept CFG>
+class WorkStealingWorklist
+{
+public:
+    WorkStealingWorklist(const CFG& cfg, unsigned workers);
+    void enqueue(unsigned worker, int node);
+    void enqueueSuccessors(unsigned worker, int node);
+    // Waits for a block to process, returns -1 when all the blocks are
+    // processed or `stop` was called.
+    int dequeue(unsigned worker);
+    // Must be called after processing a dequeued block and enqueuing its
+    // successors.
+    void finish(unsigned worker, int node);
+    void stop() noexcept { stopped = true; }
+
+private:
+    enum class Status : std::uint8_t { Idle, Queued, Running, RunningAndQueued };
+    struct alignas(64) Queue
+    {
+        std::mutex mutex;
+        std::vector<int> heap;
+    };
+    void push(unsigned worker, int node);
+    std::optional<int> pop(unsigned worker);
+
+    const CFG& cfg;
+    std::optional<DfsTree> uncachedDfs; // Only for CFGs without a DFS tree.
+    RPOCompare comparator;
+    std::vector<Queue> queues;
+    std::vector<std::atomic<Status>> status;
+    // The blocks that are queued or being processed.
+    std::atomic<std::size_t> pending = 0;
+    std::atomic<bool> stopped = false;
+};
+
+template<CfgConcept CFG>
+WorkStealingWorklist<CFG>::WorkStealingWorklist(const CFG& cfg, unsigned workers)
+  : cfg(cfg), comparator(getDfsTree(cfg, uncachedDfs)), queues(workers),
+    status(cfg.blocks().size()) {}
+
+template<CfgConcept CFG>
+void WorkStealingWorklist<CFG>::enqueue(unsigned worker, int node)
+{
+    Status current = status[node].load();
+    while (true)
+    {
+        switch (current)
+        {
+        case Status::Idle:
+            if (status[node].compare_exchange_weak(current, Status::Queued))
+            {
+                push(worker, node);
+                return;
+            }
+            break;
+        case Status::Running:
+            if (status[node].compare_exchange_weak(current, Status::RunningAndQueued))
+                return;
+            break;
+        case Status::Queued:
+        case Status::RunningAndQueued:
+            return;
+        }
+    }
+}
+
+template<CfgConcept CFG>
+void WorkStealingWorklist<CFG>::enqueueSuccessors(unsigned worker, int node)
+{
+    for (int succ : cfg.blocks()[node].successors())
+        enqueue(worker, succ);
+}
+
+template<CfgConcept CFG>
+int WorkStealingWorklist<CFG>::dequeue(unsigned worker)
+{
+    while (!stopped)
+    {
+        for (unsigned i = 0; i < queues.size(); ++i)
+        {
+            if (auto node = pop((worker + i) % queues.size()))
+            {
+                status[*node].store(Status::Running);
+                return *node;
+            }
+        }
+        if (pending == 0)
+            break;
+        std::this_thread::yield();
+    }
+    return -1;
+}
+
+template<CfgConcept CFG>
+void WorkStealingWorklist<CFG>::finish(unsigned worker, int node)
+{
+    Status running = Status::Running;
+    if (!status[node].compare_exchange_strong(running, Status::Idle))
+    {
+        status[node].store(Status::Queued);
+        push(worker, node);
+    }
+    --pending;
+}
+
+template<CfgConcept CFG>
+void WorkStealingWorklist<CFG>::push(unsigned worker, int node)
+{
+    ++pending;
+    Queue& queue = queues[worker];
+    std::lock_guard lock(queue.mutex);
+    queue.heap.push_back(node);
+    std::ranges::push_heap(queue.heap, comparator);
+}
+
+template<CfgConcept CFG>
+std::optional<int> WorkStealingWorklist<CFG>::pop(unsigned worker)
+{
+    Queue& queue = queues[worker];
+    std::lock_guard lock(queue.mutex);
+    if (queue.heap.empty())
+        return std::nullopt;
+    std::ranges::pop_heap(queue.heap, comparator);
+    int node = queue.heap.back();
+    queue.heap.pop_back();
+    return node;
+}
+
+// Similar to solveMonotoneFramework, but processes the blocks on `threads`
+// workers, 0 means one per hardware thread. The calling thread is one of
+// the workers, and every worker calls its own copy of the transfer
+// function. The state at the end of each block is guarded by its own lock.
+//
+// The solver computes the least fixed point like solveMonotoneFramework, so
+// the results are the same. Only the order of the joins differs. The number
+// of processed blocks depends on the scheduling, so close to the NodeLimit
+// one of the solvers can give up while the other converges. Widening
+// depends on the order of the iteration, it is not supported.
+template<Domain D, TransferFunction<D> F, CfgConcept CFG, unsigned NodeLimit = 10>
+std::vector<D> solveMonotoneFrameworkInParallel(const CFG& cfg, unsigned threads, F transfer)
+{
+    if (threads == 0)
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    const size_t limit = NodeLimit * cfg.blocks().size();
+    std::atomic<size_t> processedNodes = 0;
+    std::atomic<bool> converged = true;
+    std::vector<D> postStates(cfg.blocks().size(), D::bottom());
+    std::vector<SpinLock> locks(cfg.blocks().size());
+    // Only accessed by the worker processing the block.
+    std::vector<char> visited(cfg.blocks().size(), false);
+    WorkStealingWorklist<CFG> w{ cfg, threads };
+    w.enqueue(0, 0);
+
+    auto work = [&](unsigned worker) {
+        F localTransfer{ transfer };
+        for (int currentBlock = w.dequeue(worker); currentBlock >= 0; currentBlock = w.dequeue(worker))
+        {
+            if (limit > 0 && processedNodes++ >= limit)
+            {
+                converged = false;
+                w.stop();
+                return;
+            }
+
+            D postState{ D::bottom() };
+            for (auto pred : cfg.blocks()[currentBlock].predecessors())
+            {
+                std::lock_guard lock(locks[pred]);
+                joinInto(postState, postStates[pred]);
+            }
+            for (Operation op : cfg.blocks()[currentBlock].operations())
+                postState = localTransfer(op, std::move(postState));
+
+            bool changed;
+            {
+                std::lock_guard lock(locks[currentBlock]);
+                changed = joinInto(postStates[currentBlock], postState);
+            }
+            if (changed || !visited[currentBlock])
+            {
+                visited[currentBlock] = true;
+                w.enqueueSuccessors(worker, currentBlock);
+            }
+            w.finish(worker, currentBlock);
+        }
+    };
+    {
+        std::vector<std::jthread> workers;
+        for (unsigned i = 1; i < threads; ++i)
+            workers.emplace_back(work, i);
+        work(0);
+    }
+
+    if (!converged)
+        return {};
+    return postStates;
+}
+
+template<Domain D, TransferFunction<D> F, CfgConcept CFG, unsigned NodeLimit = 10>
+std::vector<D> solveMonotoneFrameworkInParallel(const CFG& cfg, unsigned threads)
+{
+    return solveMonotoneFrameworkInParallel<D, F, CFG, NodeLimit>(cfg, threads, F{});
+}
+
+#endif // PARALLEL_SOLVER_H
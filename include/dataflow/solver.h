@@ -1,11 +1,16 @@
 #ifndef SOLVER_H
 #define SOLVER_H
 
+#include <algorithm>
+#include <optional>
 #include <vector>
 
 #include "include/dataflow/domains/domain.h"
 #include "include/dataflow/transfer.h"
+#include "include/block_mapping.h"
 #include "include/cfg.h"
+#include "include/scc.h"
+#include "include/wto.h"
 
 template<Domain D, CfgConcept CFG>
 using AnalysisFunc = std::vector<D>(*)(const CFG&);
@@ -35,14 +40,24 @@ using VisualizerFunc = std::vector<Polygon> (*)(const CFG& cfg, const std::vecto
 //
 // See `allAnnotationsFromAnalysisResults` how to recover
 // per-operation analysis states.
-template<Domain D, TransferFunction<D> F, CfgConcept CFG, unsigned NodeLimit = 10>
+//
+// The Worklist is RPOWorklist or BitsetRPOWorklist, both visit the
+// blocks in the same order.
+//
+// The states are joined in place with joinWith when the domain has it. The
+// new state at the end of a block is joined into the old one, the returned
+// flag tells whether it changed, so the states are never compared as a
+// whole. The states only grow in a monotone framework, so the join is the
+// new state.
+template<Domain D, TransferFunction<D> F, CfgConcept CFG, unsigned NodeLimit = 10,
+         template<typename> typename Worklist = RPOWorklist>
 std::vector<D> solveMonotoneFramework(const CFG& cfg, F transfer)
 {
     const size_t limit = NodeLimit * cfg.blocks().size();
     size_t processedNodes = 0;
     std::vector<D> postStates(cfg.blocks().size(), D::bottom());
     std::vector<bool> visited(cfg.blocks().size(), false);
-    RPOWorklist w{ cfg };
+    Worklist<CFG> w{ cfg };
     w.enqueue(0);
     while(!w.empty())
     {
@@ -50,11 +65,10 @@ std::vector<D> solveMonotoneFramework(const CFG& cfg, F transfer)
             return {};
 
         int currentBlock = w.dequeue();
-        D preState{ D::bottom() };
+        D postState{ D::bottom() };
         for (auto pred : cfg.blocks()[currentBlock].predecessors())
-            preState = preState.join(postStates[pred]);
+            joinInto(postState, postStates[pred]);
 
-        D postState{ preState };
         // TODO: support per-block transfer functions. E.g., for bitvector
         //       style analyses.
         for (Operation op : cfg.blocks()[currentBlock].operations())
@@ -62,33 +76,148 @@ std::vector<D> solveMonotoneFramework(const CFG& cfg, F transfer)
             // TODO: consider currying for transfer functions for caching.
             //       I.e., it would be possible to partially evaluate the
             //       transfer functions, see Futamura projections.
-            postState = transfer(op, postState);
+            postState = transfer(op, std::move(postState));
         }
         ++processedNodes;
         // If the state did not change we do not need to propagate the changes.
         // If the first time we visit a node the transfer function produces bottom,
         // we do not want to terminate the analysis prematurely. Not every analysis
         // uses bottom to represent dead code.
-        if (visited[currentBlock] && postStates[currentBlock] == postState)
+        if (!joinInto(postStates[currentBlock], postState) && visited[currentBlock])
             continue;
-        
+
         visited[currentBlock] = true;
-        postStates[currentBlock] = postState;
         w.enqueueSuccessors(currentBlock);
     }
 
     return postStates;
 }
 
-template<Domain D, TransferFunction<D> F, CfgConcept CFG, unsigned NodeLimit = 10>
+template<Domain D, TransferFunction<D> F, CfgConcept CFG, unsigned NodeLimit = 10,
+         template<typename> typename Worklist = RPOWorklist>
 std::vector<D> solveMonotoneFramework(const CFG& cfg)
 {
-    return solveMonotoneFramework<D, F, CFG, NodeLimit>(cfg, F{});
+    return solveMonotoneFramework<D, F, CFG, NodeLimit, Worklist>(cfg, F{});
+}
+
+// Similar to solveMonotoneFramework, but reuses the results of the analysis
+// of the program before an edit. The `mapping` must be built from the CFG
+// before the edit and the CFG of `cfg`, reversed for a ReverseCFG. The
+// `previousResults` are the results of solveMonotoneFramework before the
+// edit.
+//
+// The states of the blocks that are not reachable from a changed block are
+// reused from the previous results. The others start from bottom and are
+// solved from the changed blocks, the states before them are final. The
+// results are the same as the results of solveMonotoneFramework, but the
+// number of transfers is proportional to the blocks after the change. The
+// NodeLimit applies to these blocks. When the previous analysis did not
+// converge, everything is solved again.
+template<Domain D, TransferFunction<D> F, CfgConcept CFG, unsigned NodeLimit = 10,
+         template<typename> typename Worklist = RPOWorklist>
+std::vector<D> solveMonotoneFrameworkIncrementally(const CFG& cfg, const BlockMapping& mapping,
+                                                   std::vector<D> previousResults, F transfer)
+{
+    if (previousResults.empty())
+        return solveMonotoneFramework<D, F, CFG, NodeLimit, Worklist>(cfg, transfer);
+
+    std::optional<DfsTree> uncachedDfs;
+    const DfsTree& dfs = getDfsTree(cfg, uncachedDfs);
+    // The blocks after the changed ones, they are not visited yet.
+    std::vector<bool> visited(cfg.blocks().size(), true);
+    std::vector<int> stack;
+    for (int block : mapping.changedBlocks())
+    {
+        // The unreachable blocks stay bottom.
+        if (dfs.isReachable(block) && visited[block])
+        {
+            visited[block] = false;
+            stack.push_back(block);
+        }
+    }
+    Worklist<CFG> w{ cfg };
+    for (int block : stack)
+        w.enqueue(block);
+    size_t affected = 0;
+    while (!stack.empty())
+    {
+        int block = stack.back();
+        stack.pop_back();
+        ++affected;
+        for (auto succ : cfg.blocks()[block].successors())
+        {
+            if (visited[succ])
+            {
+                visited[succ] = false;
+                stack.push_back(succ);
+            }
+        }
+    }
+
+    // The mapping keeps the order of the blocks, so the reused states are
+    // moved in place like memmove. Most of them stay where they are.
+    std::vector<D> postStates = std::move(previousResults);
+    const int size = static_cast<int>(cfg.blocks().size());
+    auto reuse = [&](int block) {
+        const int previous = mapping.previous(block);
+        if (visited[block] && previous >= 0 && previous != block)
+            postStates[block] = std::move(postStates[previous]);
+    };
+    if (size > static_cast<int>(postStates.size()))
+    {
+        postStates.resize(size, D::bottom());
+        for (int block = size - 1; block >= 0; --block)
+            reuse(block);
+    }
+    else
+    {
+        for (int block = 0; block < size; ++block)
+            reuse(block);
+        postStates.resize(size, D::bottom());
+    }
+    for (int block = 0; block < size; ++block)
+    {
+        if (!visited[block] || mapping.previous(block) < 0)
+            postStates[block] = D::bottom();
+    }
+
+    const size_t limit = NodeLimit * affected;
+    size_t processedNodes = 0;
+    while(!w.empty())
+    {
+        if (limit > 0 && processedNodes >= limit)
+            return {};
+
+        int currentBlock = w.dequeue();
+        D postState{ D::bottom() };
+        for (auto pred : cfg.blocks()[currentBlock].predecessors())
+            joinInto(postState, postStates[pred]);
+        for (Operation op : cfg.blocks()[currentBlock].operations())
+            postState = transfer(op, std::move(postState));
+        ++processedNodes;
+        if (!joinInto(postStates[currentBlock], postState) && visited[currentBlock])
+            continue;
+
+        visited[currentBlock] = true;
+        w.enqueueSuccessors(currentBlock);
+    }
+
+    return postStates;
+}
+
+template<Domain D, TransferFunction<D> F, CfgConcept CFG, unsigned NodeLimit = 10,
+         template<typename> typename Worklist = RPOWorklist>
+std::vector<D> solveMonotoneFrameworkIncrementally(const CFG& cfg, const BlockMapping& mapping,
+                                                   std::vector<D> previousResults)
+{
+    return solveMonotoneFrameworkIncrementally<D, F, CFG, NodeLimit, Worklist>(cfg, mapping,
+                                                                              std::move(previousResults), F{});
 }
 
 // Similar to solveMonotoneFramework, but always invoke the widen
 // operation.
-template<WidenableDomain D, TransferFunction<D> F, CfgConcept CFG, unsigned NodeLimit = 10>
+template<WidenableDomain D, TransferFunction<D> F, CfgConcept CFG, unsigned NodeLimit = 10,
+         template<typename> typename Worklist = RPOWorklist>
 std::vector<D> solveMonotoneFrameworkWithWidening(const CFG& cfg, F transfer)
 {
     const size_t limit = NodeLimit * cfg.blocks().size();
@@ -96,7 +225,7 @@ std::vector<D> solveMonotoneFrameworkWithWidening(const CFG& cfg, F transfer)
     std::vector<D> preStates(cfg.blocks().size(), D::bottom());
     std::vector<D> postStates(cfg.blocks().size(), D::bottom());
     std::vector<bool> visited(cfg.blocks().size(), false);
-    RPOWorklist w{ cfg };
+    Worklist<CFG> w{ cfg };
     w.enqueue(0);
     while(!w.empty())
     {
@@ -106,31 +235,312 @@ std::vector<D> solveMonotoneFrameworkWithWidening(const CFG& cfg, F transfer)
         int currentBlock = w.dequeue();
         D newPreState{ D::bottom() };
         for (auto pred : cfg.blocks()[currentBlock].predecessors())
-            newPreState = newPreState.join(postStates[pred]);
+            joinInto(newPreState, postStates[pred]);
 
-        preStates[currentBlock] = preStates[currentBlock].widen(newPreState);
-        D postState{ preStates[currentBlock] };
-        for (Operation op : cfg.blocks()[currentBlock].operations())
-            postState = transfer(op, postState);
-
-        ++processedNodes;
         // If the state did not change we do not need to
         // propagate the changes.
-        if (visited[currentBlock] && postStates[currentBlock] == postState)
+        if (!widenInto(preStates[currentBlock], newPreState) && visited[currentBlock])
             continue;
 
+        D postState{ preStates[currentBlock] };
+        for (Operation op : cfg.blocks()[currentBlock].operations())
+            postState = transfer(op, std::move(postState));
+
+        ++processedNodes;
         visited[currentBlock] = true;
-        postStates[currentBlock] = postState;
+        postStates[currentBlock] = std::move(postState);
         w.enqueueSuccessors(currentBlock);
     }
 
     return postStates;
 }
 
-template<WidenableDomain D, TransferFunction<D> F, CfgConcept CFG, unsigned NodeLimit = 10>
+template<WidenableDomain D, TransferFunction<D> F, CfgConcept CFG, unsigned NodeLimit = 10,
+         template<typename> typename Worklist = RPOWorklist>
 std::vector<D> solveMonotoneFrameworkWithWidening(const CFG& cfg)
 {
-    return solveMonotoneFrameworkWithWidening<D, F, CFG, NodeLimit>(cfg, F{});
+    return solveMonotoneFrameworkWithWidening<D, F, CFG, NodeLimit, Worklist>(cfg, F{});
+}
+
+// Similar to solveMonotoneFrameworkWithWidening, followed by a descending
+// iteration that narrows the states at the end of the blocks with the
+// states recomputed from their predecessors. The states after widening are
+// a post-fixpoint, so the recomputed states are not larger and the states
+// stay sound after every step. The descending phase stops after processing
+// NarrowingLimit * cfg.blocks.size() blocks even if it could improve the
+// states further.
+template<NarrowableDomain D, TransferFunction<D> F, CfgConcept CFG, unsigned NodeLimit = 10,
+         unsigned NarrowingLimit = 2, template<typename> typename Worklist = RPOWorklist>
+std::vector<D> solveMonotoneFrameworkWithNarrowing(const CFG& cfg, F transfer)
+{
+    std::vector<D> postStates = solveMonotoneFrameworkWithWidening<D, F, CFG, NodeLimit, Worklist>(cfg, transfer);
+    if (postStates.empty())
+        return postStates;
+
+    const size_t limit = NarrowingLimit * cfg.blocks().size();
+    size_t processedNodes = 0;
+    Worklist<CFG> w{ cfg };
+    std::optional<DfsTree> uncachedDfs;
+    for (int block : getDfsTree(cfg, uncachedDfs).rpoBlocks())
+        w.enqueue(block);
+    while (!w.empty() && processedNodes < limit)
+    {
+        int currentBlock = w.dequeue();
+        D postState{ D::bottom() };
+        for (auto pred : cfg.blocks()[currentBlock].predecessors())
+            joinInto(postState, postStates[pred]);
+        for (Operation op : cfg.blocks()[currentBlock].operations())
+            postState = transfer(op, std::move(postState));
+
+        ++processedNodes;
+        if (narrowInto(postStates[currentBlock], postState))
+            w.enqueueSuccessors(currentBlock);
+    }
+
+    return postStates;
+}
+
+template<NarrowableDomain D, TransferFunction<D> F, CfgConcept CFG, unsigned NodeLimit = 10,
+         unsigned NarrowingLimit = 2, template<typename> typename Worklist = RPOWorklist>
+std::vector<D> solveMonotoneFrameworkWithNarrowing(const CFG& cfg)
+{
+    return solveMonotoneFrameworkWithNarrowing<D, F, CFG, NodeLimit, NarrowingLimit, Worklist>(cfg, F{});
+}
+
+// Similar to solveMonotoneFrameworkWithWidening, but uses Bourdoncle's
+// recursive iteration strategy: the blocks are visited in weak topological
+// order, the components are stabilized from the innermost outwards, and
+// only the heads of the components widen. A component is stable when the
+// state at the start of its head does not change. Domains without widening
+// are only supported when they have no infinite ascending chains.
+//
+// The `wto` must be built from `cfg`, it can be reused across analyses.
+template<Domain D, TransferFunction<D> F, CfgConcept CFG, unsigned NodeLimit = 10>
+std::vector<D> solveMonotoneFrameworkWithWto(const CFG& cfg, const WeakTopologicalOrder& wto, F transfer)
+{
+    const size_t limit = NodeLimit * cfg.blocks().size();
+    size_t processedNodes = 0;
+    std::vector<D> headPreStates(cfg.blocks().size(), D::bottom());
+    std::vector<D> postStates(cfg.blocks().size(), D::bottom());
+    const auto order = wto.elements();
+    // The components being stabilized, innermost last.
+    std::vector<std::size_t> activeHeads;
+    std::size_t position = 0;
+    while (position < order.size() || !activeHeads.empty())
+    {
+        // Iterate the innermost component again.
+        if (!activeHeads.empty() && position == wto.componentEnd(activeHeads.back()))
+            position = activeHeads.back();
+
+        if (limit > 0 && processedNodes >= limit)
+            return {};
+
+        int currentBlock = order[position];
+        D preState{ D::bottom() };
+        for (auto pred : cfg.blocks()[currentBlock].predecessors())
+            joinInto(preState, postStates[pred]);
+
+        if (wto.isHead(position))
+        {
+            D& headPreState = headPreStates[currentBlock];
+            const bool changed = [&] {
+                if constexpr (WidenableDomain<D>)
+                    return widenInto(headPreState, preState);
+                else
+                    return joinInto(headPreState, preState);
+            }();
+            if (!activeHeads.empty() && activeHeads.back() == position)
+            {
+                if (!changed)
+                {
+                    position = wto.componentEnd(position);
+                    activeHeads.pop_back();
+                    continue;
+                }
+            }
+            else
+                activeHeads.push_back(position);
+            preState = headPreState;
+        }
+
+        for (Operation op : cfg.blocks()[currentBlock].operations())
+            preState = transfer(op, std::move(preState));
+
+        ++processedNodes;
+        postStates[currentBlock] = std::move(preState);
+        ++position;
+    }
+
+    return postStates;
+}
+
+template<Domain D, TransferFunction<D> F, CfgConcept CFG, unsigned NodeLimit = 10>
+std::vector<D> solveMonotoneFrameworkWithWto(const CFG& cfg, F transfer)
+{
+    return solveMonotoneFrameworkWithWto<D, F, CFG, NodeLimit>(cfg, WeakTopologicalOrder{ cfg }, transfer);
+}
+
+template<Domain D, TransferFunction<D> F, CfgConcept CFG, unsigned NodeLimit = 10>
+std::vector<D> solveMonotoneFrameworkWithWto(const CFG& cfg)
+{
+    return solveMonotoneFrameworkWithWto<D, F, CFG, NodeLimit>(cfg, F{});
+}
+
+// Similar to solveMonotoneFramework, but solves the strongly connected
+// components one at a time in topological order. The predecessors outside of
+// a component are in earlier components, so their states are final, and the
+// states of a component are never changed once it is stable. The blocks that
+// are not in a cycle are evaluated exactly once, the code after a loop is not
+// revisited when the state of the loop changes.
+//
+// The blocks of a cyclic component are iterated in reverse post-order until
+// none of them changes. Widenable domains widen at the start of the targets
+// of the back edges, every cycle goes through one of them. The states at the
+// start of these blocks only live while their component is solved.
+//
+// The `sccs` must be built from `cfg`, they can be reused across analyses.
+template<Domain D, TransferFunction<D> F, CfgConcept CFG, unsigned NodeLimit = 10>
+std::vector<D> solveMonotoneFrameworkWithScc(const CFG& cfg, const StronglyConnectedComponents& sccs, F transfer)
+{
+    const size_t limit = NodeLimit * cfg.blocks().size();
+    size_t processedNodes = 0;
+    std::vector<D> postStates(cfg.blocks().size(), D::bottom());
+    std::optional<DfsTree> uncachedDfs;
+    const DfsTree& dfs = getDfsTree(cfg, uncachedDfs);
+    for (std::size_t component = 0; component < sccs.size(); ++component)
+    {
+        const auto blocks = sccs.blocks(component);
+        if (!sccs.isCyclic(component))
+        {
+            if (limit > 0 && processedNodes >= limit)
+                return {};
+
+            const int currentBlock = blocks.front();
+            D postState{ D::bottom() };
+            for (auto pred : cfg.blocks()[currentBlock].predecessors())
+                joinInto(postState, postStates[pred]);
+            for (Operation op : cfg.blocks()[currentBlock].operations())
+                postState = transfer(op, std::move(postState));
+            ++processedNodes;
+            postStates[currentBlock] = std::move(postState);
+            continue;
+        }
+
+        // The scratch memory of the component is released as soon as the
+        // component is final. Only the loop headers keep their states
+        // before widening, ordered by their position in the component.
+        std::vector<std::size_t> headPositions;
+        std::vector<D> headPreStates;
+        if constexpr (WidenableDomain<D>)
+        {
+            for (std::size_t position = 0; position < blocks.size(); ++position)
+            {
+                if (dfs.isLoopHeader(blocks[position]))
+                    headPositions.push_back(position);
+            }
+            headPreStates.assign(headPositions.size(), D::bottom());
+        }
+        // Indexed by the position of the blocks in the component.
+        std::vector<bool> pending(blocks.size(), true);
+        std::vector<bool> visited(blocks.size(), false);
+        for (bool stable = false; !stable;)
+        {
+            stable = true;
+            for (std::size_t position = 0; position < blocks.size(); ++position)
+            {
+                if (!pending[position])
+                    continue;
+                if (limit > 0 && processedNodes >= limit)
+                    return {};
+
+                pending[position] = false;
+                const int currentBlock = blocks[position];
+                D postState{ D::bottom() };
+                for (auto pred : cfg.blocks()[currentBlock].predecessors())
+                    joinInto(postState, postStates[pred]);
+
+                bool changed = false;
+                if constexpr (WidenableDomain<D>)
+                {
+                    if (dfs.isLoopHeader(currentBlock))
+                    {
+                        const auto head = std::ranges::lower_bound(headPositions, position);
+                        D& headPreState = headPreStates[head - headPositions.begin()];
+                        if (!widenInto(headPreState, postState) && visited[position])
+                            continue;
+                        postState = headPreState;
+                        changed = true;
+                    }
+                }
+                for (Operation op : cfg.blocks()[currentBlock].operations())
+                    postState = transfer(op, std::move(postState));
+                ++processedNodes;
+                if (changed)
+                    postStates[currentBlock] = std::move(postState);
+                else
+                    changed = joinInto(postStates[currentBlock], postState);
+                if (!changed && visited[position])
+                    continue;
+
+                visited[position] = true;
+                for (auto succ : cfg.blocks()[currentBlock].successors())
+                {
+                    if (sccs.componentOf(succ) != static_cast<int>(component))
+                        continue;
+                    const std::size_t succPosition = sccs.positionInComponent(succ);
+                    pending[succPosition] = true;
+                    // The blocks after this one are still visited in this pass.
+                    if (succPosition <= position)
+                        stable = false;
+                }
+            }
+        }
+    }
+
+    return postStates;
+}
+
+template<Domain D, TransferFunction<D> F, CfgConcept CFG, unsigned NodeLimit = 10>
+std::vector<D> solveMonotoneFrameworkWithScc(const CFG& cfg, F transfer)
+{
+    return solveMonotoneFrameworkWithScc<D, F, CFG, NodeLimit>(cfg, StronglyConnectedComponents{ cfg }, transfer);
+}
+
+template<Domain D, TransferFunction<D> F, CfgConcept CFG, unsigned NodeLimit = 10>
+std::vector<D> solveMonotoneFrameworkWithScc(const CFG& cfg)
+{
+    return solveMonotoneFrameworkWithScc<D, F, CFG, NodeLimit>(cfg, F{});
+}
+
+// Recover the states at the end of the blocks of the original CFG from the
+// results of a forward analysis on the simplified CFG.
+template<Domain D, TransferFunction<D> F>
+std::vector<D> originalBlockResults(const SimplifiedCFG& simplified, const std::vector<D>& result)
+{
+    // The original blocks located in each simplified block, ordered by their end.
+    std::vector<std::vector<std::pair<int, int>>> located(simplified.cfg.blocks().size());
+    for (int original = 0; const auto& [block, operations] : simplified.originalBlocks)
+        located[block].emplace_back(operations, original++);
+
+    std::vector<D> originalStates(simplified.originalBlocks.size(), D::bottom());
+    F transfer{};
+    for (std::size_t i = 0; i < located.size(); ++i)
+    {
+        const auto& block = simplified.cfg.blocks()[i];
+        std::ranges::sort(located[i]);
+        D state{ D::bottom() };
+        for (auto pred : block.predecessors())
+            state = state.join(result[pred]);
+
+        int transferred = 0;
+        for (auto [operations, original] : located[i])
+        {
+            for (; transferred < operations; ++transferred)
+                state = transfer(block.operations()[transferred], state);
+            originalStates[original] = state;
+        }
+    }
+    return originalStates;
 }
 
 // Annotate the last operation of each CFG block with the analysis state at the end of the
@@ -143,7 +553,7 @@ Annotations blockEndAnnotationsFromAnalysisResults(const CFG& cfg, const std::ve
     for (const auto& block : cfg.blocks())
     {
         if (!block.operations().empty())
-            anns.postAnnotations[toNode(block.operations().back())].emplace_back(result[i].toString());
+            anns.postAnnotations[getNode(cfg, block.operations().back())].emplace_back(result[i].toString());
         ++i;
     }
     return anns;
@@ -165,10 +575,10 @@ Annotations allAnnotationsFromAnalysisResults(const CFG& cfg, const std::vector<
         for (auto op : block.operations())
         {
             postOperationState = transfer(op, postOperationState);
-            if constexpr (std::is_same_v<CFG, ReverseCFG>)
-                anns.preAnnotations[toNode(op)].emplace_back(postOperationState.toString());
+            if constexpr (IsReverseCfg<CFG>)
+                anns.preAnnotations[getNode(cfg, op)].emplace_back(postOperationState.toString());
             else
-                anns.postAnnotations[toNode(op)].emplace_back(postOperationState.toString());
+                anns.postAnnotations[getNode(cfg, op)].emplace_back(postOperationState.toString());
         }
     }
     return anns;
@@ -24,6 +24,7 @@ Walk createRandomWalk(const CFG& cfg, int loopiness = 1);
 
 Vec2 rotate(Vec2 toRotate, Vec2 origin, int degree);
 
-Annotations annotateWithWalks(const std::vector<Walk>& walks);
+// The walks of the CFG.
+Annotations annotateWithWalks(const CFG& cfg, const std::vector<Walk>& walks);
 
 #endif // EVAL_H
\ No newline at end of file
@@ -0,0 +1,146 @@
+#ifndef FLAT_AST_H
+#define FLAT_AST_H
+
+#include <cassert>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "include/ast.h"
+
+// 32-bit handle of a node in a FlatAST. The top bits store the kind of
+// the node, the rest is an index into the array of that kind.
+class NodeId
+{
+public:
+    static constexpr unsigned KindBits = 3;
+    static constexpr std::uint32_t MaxIndex = (std::uint32_t{1} << (32 - KindBits)) - 1;
+
+    constexpr NodeId() noexcept = default;
+    constexpr NodeId(NodeKind kind, std::uint32_t index) noexcept
+        : raw((static_cast<std::uint32_t>(kind) << (32 - KindBits)) | index)
+    {
+        assert(index <= MaxIndex);
+    }
+
+    constexpr NodeKind kind() const noexcept { return static_cast<NodeKind>(raw >> (32 - KindBits)); }
+    constexpr std::uint32_t index() const noexcept { return raw & MaxIndex; }
+
+    constexpr bool operator==(const NodeId&) const noexcept = default;
+
+    // The packed representation, e.g., for serialization.
+    constexpr std::uint32_t toRaw() const noexcept { return raw; }
+    static constexpr NodeId fromRaw(std::uint32_t raw) noexcept { return NodeId(raw); }
+
+private:
+    constexpr explicit NodeId(std::uint32_t raw) noexcept : raw(raw) {}
+
+    std::uint32_t raw = 0;
+};
+
+static_assert(sizeof(NodeId) == sizeof(std::uint32_t));
+
+// The nodes with children refer to them by index. The children of a
+// sequence are a range in the children array of the FlatAST, the
+// alternatives of a branch and the body of a loop are indices of sequences.
+struct FlatSequence
+{
+    std::uint32_t firstChild;
+    std::uint32_t childCount;
+};
+
+struct FlatBranch
+{
+    TokenId kw;
+    std::uint32_t lhs;
+    std::uint32_t rhs;
+};
+
+struct FlatLoop
+{
+    TokenId kw;
+    std::uint32_t body;
+};
+
+// Flat representation of an AST. The nodes of each kind live in their own
+// contiguous array in preorder, so the root is the first sequence. The
+// children of all the sequences are NodeIds in one shared array, and no
+// node refers to another by pointer. The operations are the same structs
+// as in the ASTContext, so a CFG built from the flat AST points into the
+// arrays of the operations. print() and CFG::createCfg() walk the flat AST
+// through the same interface as LinkedAST.
+class FlatAST
+{
+public:
+    using NodeRef = NodeId;
+
+    // Copies the AST into the flat arrays. The tokens are taken from the
+    // context, the nodes in the context can be released afterwards.
+    static FlatAST flatten(ASTContext&& context);
+
+    FlatAST(FlatAST&&) = default;
+    FlatAST& operator=(FlatAST&&) = default;
+    FlatAST(const FlatAST&) = delete;
+    FlatAST& operator=(const FlatAST&) = delete;
+
+    NodeId getRootId() const noexcept { return NodeId(NodeKind::Sequence, 0); }
+
+    static NodeKind kind(NodeId id) noexcept { return id.kind(); }
+    // The pointer to an Init, Translation or Rotation node.
+    Node getNode(NodeId id) const noexcept;
+    // The id of an Init, Translation or Rotation node of this AST.
+    NodeId getId(Node node) const noexcept;
+
+    std::span<const NodeId> children(NodeId sequence) const noexcept
+    {
+        assert(sequence.kind() == NodeKind::Sequence);
+        const FlatSequence& s = sequences[sequence.index()];
+        return std::span(sequenceChildren).subspan(s.firstChild, s.childCount);
+    }
+    NodeId lhs(NodeId branch) const noexcept
+    {
+        assert(branch.kind() == NodeKind::Branch);
+        return NodeId(NodeKind::Sequence, branches[branch.index()].lhs);
+    }
+    NodeId rhs(NodeId branch) const noexcept
+    {
+        assert(branch.kind() == NodeKind::Branch);
+        return NodeId(NodeKind::Sequence, branches[branch.index()].rhs);
+    }
+    NodeId body(NodeId loop) const noexcept
+    {
+        assert(loop.kind() == NodeKind::Loop);
+        return NodeId(NodeKind::Sequence, loops[loop.index()].body);
+    }
+
+    std::span<const Init> getInits() const noexcept { return inits; }
+    std::span<const Translation> getTranslations() const noexcept { return translations; }
+    std::span<const Rotation> getRotations() const noexcept { return rotations; }
+    std::span<const FlatSequence> getSequences() const noexcept { return sequences; }
+    std::span<const FlatBranch> getBranches() const noexcept { return branches; }
+    std::span<const FlatLoop> getLoops() const noexcept { return loops; }
+
+    const TokenBuffer& getTokens() const { return tokens; }
+    SourceLocation getLocation(TokenId id) const { return tokens.location(id); }
+
+    std::size_t getNodeCount() const noexcept;
+
+private:
+    FlatAST() = default;
+    struct Builder;
+    friend class ProgramCache;
+
+    // The arrays of the operations are not resized after the flattening,
+    // the CFGs point into them. A FlatAST loaded from a cache file views
+    // the arrays in the file.
+    MappableVector<Init> inits;
+    MappableVector<Translation> translations;
+    MappableVector<Rotation> rotations;
+    MappableVector<FlatSequence> sequences;
+    MappableVector<FlatBranch> branches;
+    MappableVector<FlatLoop> loops;
+    MappableVector<NodeId> sequenceChildren;
+    TokenBuffer tokens;
+};
+
+#endif // FLAT_AST_H
@@ -2,11 +2,15 @@
 #define LEXER_H
 
 #include <cassert>
+#include <cstdint>
+#include <iterator>
 #include <optional>
+#include <span>
 #include <string>
 #include <string_view>
 #include <vector>
 
+#include "include/scan.h"
 #include "include/utils.h"
 
 enum class TokenType : unsigned char
@@ -18,7 +22,8 @@ enum class TokenType : unsigned char
     // Literals.
     NUMBER,
 
-    // Keywords.
+    // Keywords. Must be the last ones before END_OF_FILE, the
+    // keyword table of the lexer is generated from this range.
     INIT, TRANSLATION, ROTATION, ITER, OR,
 
     END_OF_FILE
@@ -47,44 +52,180 @@ constexpr std::string_view tokenTypeToSourceName(TokenType type)
     return "";
 }
 
+// Index of a token in a TokenBuffer.
+using TokenId = std::uint32_t;
+
+struct SourceLocation
+{
+    std::string_view file;
+    unsigned line;
+    unsigned column;
+};
+
+// Maps offsets in the source to line and column numbers. Only the offsets
+// of the line starts are stored, so the tokens only need to record their
+// offset to get full location info.
+class LocationTable
+{
+public:
+    explicit LocationTable(std::string file = {}) : file(std::move(file)) {}
+
+    void addLineStart(std::uint32_t offset) { lineStarts.push_back(offset); }
+    SourceLocation locate(std::uint32_t offset) const noexcept;
+    std::string_view getFile() const noexcept { return file; }
+    std::span<const std::uint32_t> getLineStarts() const noexcept { return lineStarts; }
+
+private:
+    std::string file;
+    MappableVector<std::uint32_t> lineStarts{0};
+
+    friend class ProgramCache;
+};
+
+// Unpacked view of a single token.
 struct Token
 {
-    TokenType type;
+    TokenType type = TokenType::END_OF_FILE;
 
-    // TODO: add better location info:
-    //       location should be an index into
-    //       a table that has line number,
-    //       column number and file path.
-    unsigned line; 
+    // The line is kept for diagnostics, the column can be recovered from
+    // the offset using the LocationTable.
+    unsigned line = 0;
+    std::uint32_t offset = 0;
 
     // The value of number literals.
     std::optional<int> value;
 
-    Token(TokenType type, int line, std::optional<int> value = {}) noexcept :
-        type(type), line(line), value(std::move(value)) {}
+    Token() noexcept = default;
+    Token(TokenType type, unsigned line, std::uint32_t offset, std::optional<int> value = {}) noexcept :
+        type(type), line(line), offset(offset), value(std::move(value)) {}
 };
 
 std::string print(Token t) noexcept;
 
+// Struct-of-arrays storage for token sequences. Every token takes one byte
+// for its type and four bytes for its offset in the source. The values of
+// the number literals are stored in a separate array that only has entries
+// for NUMBER tokens.
+class TokenBuffer
+{
+public:
+    class Iterator
+    {
+    public:
+        using iterator_category = std::input_iterator_tag;
+        using value_type = Token;
+        using difference_type = std::ptrdiff_t;
+        using pointer = void;
+        using reference = Token;
+
+        Iterator() = default;
+        Iterator(const TokenBuffer* buffer, TokenId id) : buffer(buffer), id(id) {}
+
+        Token operator*() const noexcept { return (*buffer)[id]; }
+        Iterator& operator++() noexcept { ++id; return *this; }
+        Iterator operator++(int) noexcept { Iterator old = *this; ++id; return old; }
+        bool operator==(const Iterator& other) const noexcept { return id == other.id; }
+
+    private:
+        const TokenBuffer* buffer = nullptr;
+        TokenId id = 0;
+    };
+
+    explicit TokenBuffer(LocationTable locations = LocationTable{})
+        : locations(std::move(locations)) {}
+
+    TokenId push(const Token& t);
+    Token operator[](TokenId id) const noexcept;
+
+    TokenType type(TokenId id) const noexcept { return types[id]; }
+    // Only valid for NUMBER tokens.
+    int value(TokenId id) const noexcept;
+    SourceLocation location(TokenId id) const noexcept { return locations.locate(offsets[id]); }
+
+    std::size_t size() const noexcept { return types.size(); }
+    bool empty() const noexcept { return types.empty(); }
+    Iterator begin() const noexcept { return {this, 0}; }
+    Iterator end() const noexcept { return {this, static_cast<TokenId>(types.size())}; }
+
+    const LocationTable& getLocations() const noexcept { return locations; }
+    void setLocations(LocationTable table) noexcept { locations = std::move(table); }
+
+    // The number of bytes allocated for the tokens.
+    std::size_t memoryUsage() const noexcept;
+
+private:
+    LocationTable locations;
+    MappableVector<TokenType> types;
+    MappableVector<std::uint32_t> offsets;
+    // The values of the number literals and the ids of the corresponding
+    // tokens in increasing order.
+    MappableVector<int> numbers;
+    MappableVector<TokenId> numberIds;
+
+    friend class ProgramCache;
+};
+
 class Lexer
 {
 public:
-    Lexer(std::string source, const DiagnosticEmitter& diag) noexcept
-        : source(std::move(source)), diag(diag) {}
+    // The lexer does not copy the source, it must outlive the lexer.
+    // This is used to lex memory-mapped files without copying them.
+    Lexer(std::string_view source, const DiagnosticEmitter& diag, std::string file = {}) noexcept
+        : source(source), diag(diag), locations(std::move(file)) {}
+    Lexer(std::string source, const DiagnosticEmitter& diag, std::string file = {}) noexcept
+        : ownedSource(std::move(source)), source(ownedSource), diag(diag), locations(std::move(file)) {}
+
+    // The source might point into the lexer.
+    Lexer(const Lexer&) = delete;
+    Lexer& operator=(const Lexer&) = delete;
+
+    // Returns the next token on demand. Once the end of the input is
+    // reached, END_OF_FILE is returned for every subsequent call.
+    // Returns an empty optional after a lexing error.
+    std::optional<Token> next() noexcept;
+
+    // Lexes the whole input at once. Returns an empty buffer on error.
+    TokenBuffer lexAll() noexcept;
+
+    // Selects the scanning primitives, e.g., for benchmarking. By default,
+    // the best instruction set supported by the CPU is used.
+    void useScanIsa(ScanIsa isa) noexcept { scan = &getScanKernels(isa); }
 
-    std::vector<Token> lexAll() noexcept;
+    // The line starts seen so far.
+    const LocationTable& getLocations() const noexcept { return locations; }
+    LocationTable takeLocations() noexcept { return std::move(locations); }
 
 private:
     std::optional<Token> lex() noexcept;
     std::optional<Token> lexNumber() noexcept;
     std::optional<Token> lexKeyword() noexcept;
+    Token makeToken(TokenType type, std::optional<int> value = {}) const noexcept
+    {
+        return Token(type, line, start, value);
+    }
     bool isAtEnd() const noexcept { return static_cast<unsigned>(current) >= source.length(); }
-    char advance() noexcept { return source[current++]; }
+    const char* cursor() const noexcept { return source.data() + current; }
+    const char* sourceEnd() const noexcept { return source.data() + source.size(); }
+    // Skips to target while keeping track of the new lines.
+    void skipTo(const char* target) noexcept;
+    char advance() noexcept
+    {
+        char c = source[current++];
+        if (c == '\n')
+        {
+            ++line;
+            locations.addLineStart(current);
+        }
+        return c;
+    }
     char peek() const noexcept;
     bool match(char expected) noexcept;
 
-    std::string source;
+    std::string ownedSource;
+    std::string_view source;
     const DiagnosticEmitter& diag;
+    LocationTable locations;
+    const ScanKernels* scan = &getScanKernels();
     int start = 0;
     int current = 0;
     int line = 1;
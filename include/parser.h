@@ -1,8 +1,9 @@
 #ifndef PARSER_H
 #define PARSER_H
 
-#include <vector>
+#include <array>
 #include <optional>
+#include <vector>
 
 #include "fmt/format.h"
 
@@ -19,20 +20,28 @@
 class Parser
 {
 public:
-    Parser(std::vector<Token> tokens,
-           const DiagnosticEmitter& diag) noexcept : tokens(std::move(tokens)), diag(diag) {}
+    // Pulls the tokens from the lexer on demand, so lexing and parsing
+    // are interleaved and the tokens are never stored all at once.
+    Parser(Lexer& lexer, const DiagnosticEmitter& diag) noexcept
+        : lexer(&lexer), diag(diag) { pull(); }
+
+    // Parses an already lexed token sequence.
+    Parser(TokenBuffer tokens, const DiagnosticEmitter& diag) noexcept
+        : tokens(std::move(tokens)), diag(diag) { pull(); }
 
     std::optional<ASTContext> parse();
 
 private:
-    std::optional<const Sequence*> sequence(bool root = false);
-    std::optional<const Branch*> branch();
-    std::optional<const Loop*> loop();
+    std::optional<const Sequence*> sequence();
+    // Finishes the innermost open loop or branch after its sequence `seq`.
+    // Returns the finished node, or an empty node when only the left
+    // alternative of a branch was finished.
+    std::optional<std::optional<Node>> closeBlock(const Sequence* seq);
     std::optional<Node> command();
 
     // Utilities.
-    Token peek() const noexcept { return tokens[current]; }
-    Token previous() const noexcept { return tokens[current - 1]; }
+    Token peek() const noexcept { return lookahead[current % LookaheadSize]; }
+    Token previous() const noexcept { return lookahead[(current - 1) % LookaheadSize]; }
     bool isAtEnd() const noexcept
     {
         return peek().type == TokenType::END_OF_FILE;
@@ -55,10 +64,17 @@ private:
 
     Token advance() noexcept
     {
-        if (!isAtEnd()) ++current;
+        if (!isAtEnd())
+        {
+            ++current;
+            pull();
+        }
         return previous();
     }
 
+    // Fetches the token at the current position into the lookahead buffer.
+    void pull() noexcept;
+
     std::optional<Token> consume(TokenType type, std::string_view message = "") noexcept
     {
         if (check(type))
@@ -74,7 +90,30 @@ private:
     void error(Token t, std::string_view message) const noexcept;
 
     ASTContext context;
-    std::vector<Token> tokens;
+    // Scratch space for the commands of the sequences being parsed.
+    std::vector<Node> commandStack;
+    // The loops and branches whose closing brace was not reached yet.
+    struct OpenBlock
+    {
+        enum Kind { LoopBody, BranchLhs, BranchRhs } kind;
+        Token kw;
+        // The commands of the block's sequence start here in commandStack.
+        std::size_t firstCommand;
+        const Sequence* lhs = nullptr;
+    };
+    std::vector<OpenBlock> openBlocks;
+
+    // The token source is either the lexer or an already lexed sequence.
+    Lexer* lexer = nullptr;
+    TokenBuffer tokens;
+    unsigned nextToken = 0;
+    // Set when the token source failed. The lexer already reported the
+    // problem, so no further diagnostics are emitted.
+    bool lexError = false;
+
+    // The parser only ever looks at the current and the previous token.
+    static constexpr unsigned LookaheadSize = 4;
+    std::array<Token, LookaheadSize> lookahead;
     unsigned current = 0;
     const DiagnosticEmitter& diag;
 };
@@ -0,0 +1,46 @@
+#ifndef SCAN_H
+#define SCAN_H
+
+#include <string_view>
+
+// Scanning primitives used by the lexer to skip over the uninteresting
+// parts of the input in bulk. There is a vectorized implementation for
+// each supported instruction set, the best one is selected at runtime.
+enum class ScanIsa
+{
+    Scalar,
+    SSE2,
+    AVX2
+};
+
+constexpr bool isWhitespace(char c) noexcept
+{
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+constexpr bool isDigit(char c) noexcept
+{
+    return c >= '0' && c <= '9';
+}
+
+struct ScanKernels
+{
+    // Returns the first character in [begin, end) that is not a space,
+    // tab, carriage return or new line; end if there is none.
+    const char* (*skipWhitespace)(const char* begin, const char* end) noexcept;
+    // Returns the first character in [begin, end) that is not a digit; end
+    // if there is none.
+    const char* (*skipDigits)(const char* begin, const char* end) noexcept;
+    // Returns the first occurrence of c in [begin, end); end if there is none.
+    const char* (*find)(const char* begin, const char* end, char c) noexcept;
+};
+
+bool isSupported(ScanIsa isa) noexcept;
+std::string_view toString(ScanIsa isa) noexcept;
+
+// Returns the kernels for the best instruction set supported by the CPU.
+const ScanKernels& getScanKernels() noexcept;
+// The instruction set must be supported.
+const ScanKernels& getScanKernels(ScanIsa isa) noexcept;
+
+#endif // SCAN_H
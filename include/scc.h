@@ -0,0 +1,156 @@
+#ifndef SCC_H
+#define SCC_H
+
+#include "include/cfg.h"
+
+#include <algorithm>
+#include <optional>
+#include <span>
+#include <string>
+#include <utility>
+#include <vector>
+
+// The strongly connected components of the blocks reachable from the start
+// block from Tarjan's algorithm, in topological order: the edges between
+// components only go forward. The blocks of a component are in reverse
+// post-order.
+class StronglyConnectedComponents
+{
+public:
+    template<CfgConcept CFG>
+    explicit StronglyConnectedComponents(const CFG& cfg);
+
+    std::size_t size() const noexcept { return cyclic.size(); }
+    std::span<const int> blocks(std::size_t component) const noexcept
+    {
+        return std::span<const int>(order).subspan(starts[component], starts[component + 1] - starts[component]);
+    }
+    // -1 for the unreachable blocks.
+    int componentOf(int block) const noexcept { return componentIds[block]; }
+    // The index of a block in the blocks of its component.
+    std::size_t positionInComponent(int block) const noexcept { return positions[block]; }
+    // More than one block, or a single block with an edge to itself.
+    bool isCyclic(std::size_t component) const noexcept { return cyclic[component]; }
+    // E.g., "0 (1 2 3) 4" where the parentheses delimit the cyclic components.
+    std::string toString() const;
+
+private:
+    std::vector<int> order;
+    std::vector<int> starts;
+    std::vector<int> componentIds;
+    std::vector<int> positions;
+    std::vector<bool> cyclic;
+};
+
+// Uses an explicit stack instead of the recursion in the original algorithm.
+// A visited block is on the stack of the algorithm until its component is
+// found, so that is tracked by the component ids.
+template<CfgConcept CFG>
+StronglyConnectedComponents::StronglyConnectedComponents(const CFG& cfg)
+  : componentIds(cfg.blocks().size(), -1), positions(cfg.blocks().size(), -1)
+{
+    struct Frame
+    {
+        int block;
+        std::size_t nextSucc = 0;
+    };
+    std::vector<int> index(cfg.blocks().size(), -1);
+    std::vector<int> lowlink(cfg.blocks().size(), 0);
+    std::vector<int> stack;
+    std::vector<Frame> frames;
+    int counter = 0;
+    int found = 0;
+    auto startVisit = [&](int block) {
+        index[block] = lowlink[block] = counter++;
+        stack.push_back(block);
+        frames.push_back({block});
+    };
+
+    // The components are found in reverse topological order.
+    startVisit(0);
+    while (!frames.empty())
+    {
+        // The reference is invalidated when a frame is pushed.
+        Frame& frame = frames.back();
+        auto succs = cfg.blocks()[frame.block].successors();
+        if (frame.nextSucc < static_cast<std::size_t>(std::ranges::distance(succs)))
+        {
+            int succ = *std::next(succs.begin(), frame.nextSucc++);
+            if (index[succ] < 0)
+                startVisit(succ);
+            else if (componentIds[succ] < 0)
+                lowlink[frame.block] = std::min(lowlink[frame.block], index[succ]);
+            continue;
+        }
+
+        const int block = frame.block;
+        frames.pop_back();
+        if (!frames.empty())
+            lowlink[frames.back().block] = std::min(lowlink[frames.back().block], lowlink[block]);
+        if (lowlink[block] != index[block])
+            continue;
+
+        const std::size_t start = order.size();
+        int element;
+        do
+        {
+            element = stack.back();
+            stack.pop_back();
+            componentIds[element] = found;
+            order.push_back(element);
+        } while (element != block);
+        const bool selfLoop = std::ranges::any_of(cfg.blocks()[block].successors(),
+                                                  [block](int succ) { return succ == block; });
+        cyclic.push_back(order.size() - start > 1 || selfLoop);
+        starts.push_back(static_cast<int>(order.size() - start));
+        ++found;
+    }
+
+    // Renumber the components in topological order.
+    std::ranges::reverse(order);
+    std::reverse(cyclic.begin(), cyclic.end());
+    // The sizes of the components are turned into their starts.
+    std::ranges::reverse(starts);
+    starts.push_back(0);
+    for (int start = 0; int& count : starts)
+        start += std::exchange(count, start);
+    for (int& id : componentIds)
+    {
+        if (id >= 0)
+            id = found - 1 - id;
+    }
+
+    std::optional<DfsTree> uncachedDfs;
+    const DfsTree& dfs = getDfsTree(cfg, uncachedDfs);
+    for (std::size_t component = 0; component < size(); ++component)
+    {
+        auto first = order.begin() + starts[component];
+        auto last = order.begin() + starts[component + 1];
+        std::sort(first, last, [&](int lhs, int rhs) { return dfs.rpoPosition(lhs) < dfs.rpoPosition(rhs); });
+        for (auto it = first; it != last; ++it)
+            positions[*it] = static_cast<int>(it - first);
+    }
+}
+
+inline std::string StronglyConnectedComponents::toString() const
+{
+    std::string result;
+    for (std::size_t component = 0; component < size(); ++component)
+    {
+        if (component > 0)
+            result += ' ';
+        if (isCyclic(component))
+            result += '(';
+        for (std::size_t i = 0; int block : blocks(component))
+        {
+            if (i++ > 0)
+                result += ' ';
+            result += std::to_string(block);
+        }
+        if (isCyclic(component))
+            result += ')';
+    }
+    return result;
+}
+
+#endif // SCC_H
@@ -1,7 +1,12 @@
 #ifndef UTILS_H
 #define UTILS_H
 
+#include <cassert>
+#include <initializer_list>
 #include <iosfwd>
+#include <optional>
+#include <span>
+#include <string>
 #include <string_view>
 #include <vector>
 
@@ -21,6 +26,129 @@ private:
     std::ostream& err;
 };
 
+// Read-only content of a source file. Regular files are memory-mapped so
+// the content is never copied, other files (e.g., pipes) and the cases where
+// mapping is not possible or not requested fall back to reading the whole
+// file into memory.
+class SourceFile
+{
+public:
+    static std::optional<SourceFile> open(std::string_view path, bool allowMmap = true) noexcept;
+
+    SourceFile(SourceFile&& other) noexcept;
+    SourceFile& operator=(SourceFile&&) = delete;
+    SourceFile(const SourceFile&) = delete;
+    SourceFile& operator=(const SourceFile&) = delete;
+    ~SourceFile();
+
+    std::string_view content() const noexcept { return view; }
+    bool isMapped() const noexcept { return mapped != nullptr; }
+
+private:
+    SourceFile() = default;
+
+    void* mapped = nullptr;
+    std::size_t mappedSize = 0;
+    std::string buffer; // Only used when the file is not mapped.
+    std::string_view view;
+};
+
+// A vector whose elements can also live elsewhere, e.g., in a memory-mapped
+// file. A view does not own its elements, they must outlive it, and it
+// cannot be modified. Both are read through the same interface.
+template<typename T>
+class MappableVector
+{
+public:
+    MappableVector() = default;
+    MappableVector(std::initializer_list<T> init) : owned(init) { sync(); }
+    MappableVector(std::vector<T> elements) noexcept : owned(std::move(elements)) { sync(); }
+    static MappableVector view(std::span<const T> elements) noexcept
+    {
+        MappableVector result;
+        result.elements = elements.data();
+        result.count = elements.size();
+        return result;
+    }
+
+    MappableVector(const MappableVector& other) : owned(other.owned), elements(other.elements), count(other.count)
+    {
+        if (!other.isView())
+            sync();
+    }
+    MappableVector(MappableVector&& other) noexcept
+        : owned(std::move(other.owned)), elements(other.elements), count(other.count)
+    {
+        other.owned.clear();
+        other.sync();
+    }
+    MappableVector& operator=(const MappableVector& other) { return *this = MappableVector(other); }
+    MappableVector& operator=(MappableVector&& other) noexcept
+    {
+        owned = std::move(other.owned);
+        elements = other.elements;
+        count = other.count;
+        other.owned.clear();
+        other.sync();
+        return *this;
+    }
+
+    bool isView() const noexcept { return elements != owned.data(); }
+    const T* data() const noexcept { return elements; }
+    std::size_t size() const noexcept { return count; }
+    bool empty() const noexcept { return count == 0; }
+    const T* begin() const noexcept { return elements; }
+    const T* end() const noexcept { return elements + count; }
+    const T& operator[](std::size_t i) const noexcept { return elements[i]; }
+    const T& front() const noexcept { return elements[0]; }
+    const T& back() const noexcept { return elements[count - 1]; }
+    // A view allocates nothing.
+    std::size_t capacity() const noexcept { return owned.capacity(); }
+
+    // Only the vectors that own their elements can be modified.
+    std::span<T> mutableSpan() noexcept
+    {
+        assert(!isView());
+        return owned;
+    }
+    void push_back(const T& value)
+    {
+        assert(!isView());
+        owned.push_back(value);
+        sync();
+    }
+    void resize(std::size_t size)
+    {
+        assert(!isView());
+        owned.resize(size);
+        sync();
+    }
+    void reserve(std::size_t size)
+    {
+        assert(!isView());
+        owned.reserve(size);
+        sync();
+    }
+    template<typename It>
+    void append(It first, It last)
+    {
+        assert(!isView());
+        owned.insert(owned.end(), first, last);
+        sync();
+    }
+
+private:
+    void sync() noexcept
+    {
+        elements = owned.data();
+        count = owned.size();
+    }
+
+    std::vector<T> owned;
+    const T* elements = nullptr;
+    std::size_t count = 0;
+};
+
 template<typename T>
 struct Finally
 {
@@ -52,4 +180,4 @@ inline Vec2 operator+(Vec2 lhs, Vec2 rhs)
 
 using Polygon = std::vector<Vec2>;
 
-#endif // UTILS_H
\ No newline at end of file
+#endif // UTILS_H
\ No newline at end of file
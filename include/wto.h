@@ -0,0 +1,209 @@
+#ifndef WTO_H
+#define WTO_H
+
+#include "include/cfg.h"
+
+#include <limits>
+#include <span>
+#include <string>
+#include <vector>
+
+// Bourdoncle's weak topological order of the blocks reachable from the start
+// block. A component is a head followed by the elements of its body, the
+// bodies can contain nested components. Every cycle of the CFG goes through
+// the head of a component containing it, so these are the only blocks where
+// a solver needs to widen.
+class WeakTopologicalOrder
+{
+public:
+    template<CfgConcept CFG>
+    explicit WeakTopologicalOrder(const CFG& cfg);
+
+    // The blocks in the order of the WTO.
+    std::span<const int> elements() const noexcept { return order; }
+    bool isHead(std::size_t position) const noexcept { return ends[position] >= 0; }
+    // The position after the last element of the component of a head.
+    std::size_t componentEnd(std::size_t position) const noexcept { return ends[position]; }
+    // E.g., "0 (1 2 (3) 4) 5" where the parentheses delimit the components.
+    std::string toString() const;
+
+private:
+    std::vector<int> order;
+    // The end of the component for heads, -1 for other elements.
+    std::vector<int> ends;
+};
+
+// Uses explicit stacks instead of the recursion in the original algorithm,
+// the native stack usage does not depend on the depth of the DFS.
+template<CfgConcept CFG>
+WeakTopologicalOrder::WeakTopologicalOrder(const CFG& cfg)
+{
+    constexpr int Finished = std::numeric_limits<int>::max();
+    // A block, or a component when it has a nested partition.
+    struct Element
+    {
+        int block;
+        int partition;
+    };
+    // The algorithm prepends to the partitions, they are stored reversed.
+    std::vector<std::vector<Element>> partitions(1);
+
+    // The activation records of visit and component from the paper.
+    struct Frame
+    {
+        bool component;
+        int block;
+        // Where the results are prepended.
+        int partition;
+        std::size_t nextSucc = 0;
+        int head = 0;
+        bool loop = false;
+        bool waitingForVisit = false;
+        bool waitingForComponent = false;
+    };
+    std::vector<int> dfn(cfg.blocks().size(), 0);
+    std::vector<int> visiting;
+    std::vector<Frame> frames;
+    int counter = 0;
+    int returned = 0;
+    auto startVisit = [&](int block, int partition) {
+        visiting.push_back(block);
+        dfn[block] = ++counter;
+        frames.push_back({.component = false, .block = block, .partition = partition, .head = counter});
+    };
+
+    startVisit(0, 0);
+    while (!frames.empty())
+    {
+        // The reference is invalidated when a frame is pushed.
+        Frame& frame = frames.back();
+        auto succs = cfg.blocks()[frame.block].successors();
+        const std::size_t succCount = std::ranges::distance(succs);
+        if (frame.component)
+        {
+            if (frame.nextSucc < succCount)
+            {
+                int succ = *std::next(succs.begin(), frame.nextSucc++);
+                if (dfn[succ] == 0)
+                    startVisit(succ, frame.partition);
+                continue;
+            }
+            const int nested = frame.partition;
+            const int block = frame.block;
+            frames.pop_back();
+            // The visit that started the component prepends it.
+            partitions[frames.back().partition].push_back({block, nested});
+            continue;
+        }
+
+        if (frame.waitingForVisit)
+        {
+            frame.waitingForVisit = false;
+            if (returned <= frame.head)
+            {
+                frame.head = returned;
+                frame.loop = true;
+            }
+        }
+        if (frame.waitingForComponent)
+        {
+            returned = frame.head;
+            frames.pop_back();
+            continue;
+        }
+        if (frame.nextSucc < succCount)
+        {
+            int succ = *std::next(succs.begin(), frame.nextSucc++);
+            if (dfn[succ] == 0)
+            {
+                frame.waitingForVisit = true;
+                startVisit(succ, frame.partition);
+            }
+            else if (dfn[succ] <= frame.head)
+            {
+                frame.head = dfn[succ];
+                frame.loop = true;
+            }
+            continue;
+        }
+
+        if (frame.head == dfn[frame.block])
+        {
+            dfn[frame.block] = Finished;
+            int element = visiting.back();
+            visiting.pop_back();
+            if (frame.loop)
+            {
+                while (element != frame.block)
+                {
+                    dfn[element] = 0;
+                    element = visiting.back();
+                    visiting.pop_back();
+                }
+                frame.waitingForComponent = true;
+                const int block = frame.block;
+                partitions.emplace_back();
+                frames.push_back({.component = true, .block = block,
+                                  .partition = static_cast<int>(partitions.size() - 1)});
+                continue;
+            }
+            partitions[frame.partition].push_back({frame.block, -1});
+        }
+        returned = frame.head;
+        frames.pop_back();
+    }
+
+    // Flatten the partitions, the ends of the components are filled in when
+    // all of their elements are added.
+    struct Open
+    {
+        int partition;
+        std::size_t remaining;
+        int headPosition;
+    };
+    std::vector<Open> open{{0, partitions[0].size(), -1}};
+    while (!open.empty())
+    {
+        Open& top = open.back();
+        if (top.remaining == 0)
+        {
+            if (top.headPosition >= 0)
+                ends[top.headPosition] = order.size();
+            open.pop_back();
+            continue;
+        }
+        Element element = partitions[top.partition][--top.remaining];
+        order.push_back(element.block);
+        ends.push_back(-1);
+        if (element.partition >= 0)
+        {
+            open.push_back({element.partition, partitions[element.partition].size(),
+                            static_cast<int>(order.size() - 1)});
+        }
+    }
+}
+
+inline std::string WeakTopologicalOrder::toString() const
+{
+    std::string result;
+    std::vector<std::size_t> openEnds;
+    for (std::size_t i = 0; i < order.size(); ++i)
+    {
+        if (i > 0)
+            result += ' ';
+        if (isHead(i))
+        {
+            result += '(';
+            openEnds.push_back(componentEnd(i));
+        }
+        result += std::to_string(order[i]);
+        while (!openEnds.empty() && openEnds.back() == i + 1)
+        {
+            result += ')';
+            openEnds.pop_back();
+        }
+    }
+    return result;
+}
+
+#endif // WTO_H
@@ -1,15 +1,25 @@
 #include <fmt/format.h>
+#include <fmt/ostream.h>
 
-#include <string_view>
-#include <iostream>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <fstream>
+#include <iostream>
+#include <mutex>
 #include <sstream>
+#include <string_view>
+#include <thread>
+
+#include <unistd.h>
 
 #include "include/eval.h"
 #include "include/cfg.h"
+#include "include/cfg_export.h"
 #include "include/parser.h"
 #include "include/render.h"
 #include "include/analyze.h"
+#include "include/cache.h"
 #include "include/utils.h"
 
 using namespace std::literals;
@@ -20,38 +30,130 @@ struct Config
 {
     bool dumpCfg = false;
     bool dumpReverseCfg = false;
+    // Dot when not given.
+    std::optional<CfgFormat> dumpFormat;
+    // Dumps, analyses and executions use the simplified CFG.
+    bool simplifyCfg = false;
     bool svg = false;
     bool dotsOnly = false;
     bool annotateTrace = false;
+    bool mmapInput = true;
+    // The inputs are cache files written with --emit-cache.
+    bool fromCache = false;
+    std::optional<std::string> cacheOutput;
     int iterations = 1;
     int loopiness = 1;
+    // Number of threads processing the files in batch mode.
+    unsigned jobs = 0;
     std::optional<std::string> analysisName;
 };
 
-bool runFile(std::string_view filePath, Config config)
+// Where the results of processing a single file go.
+struct FileOutput
+{
+    std::ostream& out;
+    std::ostream& err;
+    std::size_t bytes = 0;
+    // The dumps are written straight to this file descriptor when it is set.
+    int fd = -1;
+};
+
+// The AST and the CFG of an input, either parsed from the source or loaded
+// from a cache file.
+struct Program
 {
-    DiagnosticEmitter emitter(std::cout, std::cerr);
-    std::ifstream file(filePath.data());
+    std::optional<ASTContext> context{};
+    std::optional<CFG> cfg{};
+    std::optional<CachedProgram> cached{};
+
+    std::string print(const Annotations& anns) const
+    {
+        return cached ? ::print(cached->ast, anns) : ::print(context->getRoot(), anns);
+    }
+    const CFG& getCfg() const { return cached ? cached->cfg : *cfg; }
+};
+
+std::optional<Program> loadProgram(std::string_view filePath, const Config& config, FileOutput& output)
+{
+    auto& [out, err, bytes, fd] = output;
+    auto file = SourceFile::open(filePath, config.mmapInput);
     if (!file)
     {
-        fmt::print(stderr, "Unable to open file '{}'.\n", filePath);
-        return false;
+        fmt::print(err, "Unable to open file '{}'.\n", filePath);
+        return {};
     }
-    std::stringstream fileContent;
-    fileContent << file.rdbuf();
-    Lexer lexer(std::move(fileContent).str(), emitter);
-    auto tokens = lexer.lexAll();
-    if (tokens.empty())
-        return false;
-    Parser parser(tokens, emitter);
+    bytes = file->content().size();
+    if (config.fromCache)
+    {
+        auto cached = ProgramCache::load(std::move(*file));
+        if (!cached)
+        {
+            fmt::print(err, "Invalid or outdated cache file '{}'.\n", filePath);
+            return {};
+        }
+        return Program{.cached = std::move(cached)};
+    }
+
+    DiagnosticEmitter emitter(out, err);
+    Lexer lexer(file->content(), emitter);
+    Parser parser(lexer, emitter);
     auto context = parser.parse();
     if (!context)
-        return false;
+        return {};
+    if (config.cacheOutput)
+    {
+        // The cached CFG refers to the nodes of the flat AST.
+        auto ast = FlatAST::flatten(std::move(*context));
+        CFG cfg = CFG::createCfg(ast);
+        if (!ProgramCache::write(*config.cacheOutput, ast, cfg))
+        {
+            fmt::print(err, "Unable to write cache file '{}'.\n", *config.cacheOutput);
+            return {};
+        }
+        return Program{.cached = CachedProgram{std::move(ast), std::move(cfg)}};
+    }
     CFG cfg = CFG::createCfg(context->getRoot());
-    if (config.dumpCfg)
-        fmt::print("{}\n", print(cfg));
-    if (config.dumpReverseCfg)
-        fmt::print("{}\n", print(ReverseCFG(cfg)));
+    return Program{.context = std::move(context), .cfg = std::move(cfg)};
+}
+
+// Streams the CFG through a buffer instead of formatting all of it first.
+template<CfgConcept CFG>
+bool dumpCfg(const CFG& cfg, CfgFormat format, FileOutput& output)
+{
+    auto dump = [&](BufferedWriter& writer) {
+        exportCfg(cfg, format, writer);
+        if (format != CfgFormat::EdgeList)
+            writer.write("\n");
+        writer.flush();
+        if (!writer.ok())
+            fmt::print(output.err, "Unable to write the CFG dump.\n");
+        return writer.ok();
+    };
+    if (output.fd < 0)
+    {
+        BufferedWriter writer(output.out);
+        return dump(writer);
+    }
+    output.out.flush();
+    BufferedWriter writer(output.fd);
+    return dump(writer);
+}
+
+bool runFile(std::string_view filePath, const Config& config, FileOutput& output)
+{
+    auto program = loadProgram(filePath, config, output);
+    if (!program)
+        return false;
+    auto& [out, err, bytes, fd] = output;
+    std::optional<SimplifiedCFG> simplified;
+    if (config.simplifyCfg)
+        simplified = program->getCfg().simplify();
+    const CFG& cfg = simplified ? simplified->cfg : program->getCfg();
+    const CfgFormat format = config.dumpFormat.value_or(CfgFormat::Dot);
+    if (config.dumpCfg && !dumpCfg(cfg, format, output))
+        return false;
+    if (config.dumpReverseCfg && !dumpCfg(ReverseCFG(cfg), format, output))
+        return false;
     Annotations annotations;
     std::vector<Polygon> covered;
     if (config.analysisName)
@@ -59,12 +161,12 @@ bool runFile(std::string_view filePath, Config config)
         auto analysisResult = getAnalysisResults(*config.analysisName, cfg);
         if (!analysisResult)
         {
-            fmt::print(stderr, "Failed to run analysis '{}'.\n", *config.analysisName);
+            fmt::print(err, "Failed to run analysis '{}'.\n", *config.analysisName);
             return false;
         }
         if (!analysisResult->converged)
         {
-            fmt::print(stderr, "Analysis '{}' did not converge in the iteration limit.\n", *config.analysisName);
+            fmt::print(err, "Analysis '{}' did not converge in the iteration limit.\n", *config.analysisName);
             return false;
         }
         annotations = std::move(analysisResult->annotations);
@@ -81,20 +183,104 @@ bool runFile(std::string_view filePath, Config config)
             !config.dumpReverseCfg)
         {
             if (config.iterations > 1)
-                fmt::print("{}. execution:\n", i + 1);
+                fmt::print(out, "{}. execution:\n", i + 1);
             for (auto step : walks.back())
-                fmt::print("{{ x: {}, y: {} }}\n", step.pos.x, step.pos.y);
+                fmt::print(out, "{{ x: {}, y: {} }}\n", step.pos.x, step.pos.y);
         }
     }
     if (config.annotateTrace)
-        fmt::print("{}\n", print(context->getRoot(), annotateWithWalks(walks)));
+        fmt::print(out, "{}\n", program->print(annotateWithWalks(program->getCfg(), walks)));
     if (config.svg)
-        fmt::print("{}\n", renderRandomWalkSVG(walks, covered, config.dotsOnly));
+        fmt::print(out, "{}\n", renderRandomWalkSVG(walks, covered, config.dotsOnly));
     else if (config.analysisName)
-        fmt::print("{}\n", print(context->getRoot(), annotations));
+        fmt::print(out, "{}\n", program->print(annotations));
     return true;
 }
 
+// Processes the files on a pool of threads. The output of every file is
+// buffered and printed in the order of the files, followed by its status.
+bool runBatch(const std::vector<std::string>& files, const Config& config)
+{
+    struct Report
+    {
+        std::stringstream out;
+        std::stringstream err;
+        std::size_t bytes = 0;
+        bool ok = false;
+        bool done = false;
+    };
+    std::vector<Report> reports(files.size());
+    std::mutex mutex;
+    std::condition_variable finished;
+    std::atomic<std::size_t> nextFile = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    const unsigned threads = config.jobs ? config.jobs : std::max(1u, std::thread::hardware_concurrency());
+    const auto jobs = static_cast<unsigned>(std::min<std::size_t>(threads, files.size()));
+    std::vector<std::jthread> workers;
+    for (unsigned i = 0; i < jobs; ++i)
+    {
+        workers.emplace_back([&] {
+            for (std::size_t idx = nextFile++; idx < files.size(); idx = nextFile++)
+            {
+                Report& report = reports[idx];
+                FileOutput output{report.out, report.err};
+                bool ok = runFile(files[idx], config, output);
+                {
+                    std::lock_guard lock(mutex);
+                    report.bytes = output.bytes;
+                    report.ok = ok;
+                    report.done = true;
+                }
+                finished.notify_all();
+            }
+        });
+    }
+
+    std::size_t failures = 0;
+    std::size_t bytes = 0;
+    for (std::size_t idx = 0; idx < files.size(); ++idx)
+    {
+        Report& report = reports[idx];
+        {
+            std::unique_lock lock(mutex);
+            finished.wait(lock, [&report] { return report.done; });
+        }
+        fmt::print("==> {} <==\n", files[idx]);
+        std::cout << report.out.str() << std::flush;
+        std::cerr << report.err.str() << std::flush;
+        fmt::print("[{}] {}\n", report.ok ? "ok" : "failed", files[idx]);
+        failures += !report.ok;
+        bytes += report.bytes;
+        // The output is not needed anymore.
+        report.out = {};
+        report.err = {};
+    }
+
+    auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    fmt::print(stderr, "Processed {} files ({} failed), {:.2f} MB in {:.3f} s using {} threads: "
+                       "{:.1f} files/s, {:.2f} MB/s.\n",
+               files.size(), failures, bytes / 1e6, elapsed, jobs,
+               files.size() / elapsed, bytes / 1e6 / elapsed);
+    return failures == 0;
+}
+
+// Reads one path per line, empty lines are ignored.
+std::optional<std::vector<std::string>> readFileList(std::string_view listPath)
+{
+    std::ifstream list{std::string(listPath)};
+    if (!list)
+        return {};
+    std::vector<std::string> files;
+    std::string line;
+    while (std::getline(list, line))
+    {
+        if (!line.empty())
+            files.push_back(std::move(line));
+    }
+    return files;
+}
+
 std::optional<int> toInt(const std::string& str)
 {
     try
@@ -116,16 +302,23 @@ int main(int argc, const char* argv[])
 {
     auto printHelp = [=]()
     {
-        fmt::print("Usage: {} script [options]\n", argv[0]);
+        fmt::print("Usage: {} script... [options]\n", argv[0]);
         fmt::print("Options:\n");
         fmt::print("  --cfg-dump\n");
         fmt::print("  --reverse-cfg-dump\n");
+        fmt::print("  --dump-format dot|json|edges\n");
+        fmt::print("  --simplify-cfg\n");
         fmt::print("  --svg\n");
         fmt::print("  --dots-only\n");
         fmt::print("  --executions NUMBER\n");
         fmt::print("  --loopiness NUMBER\n");
         fmt::print("  --analyze ANALYSIS_NAME\n");
         fmt::print("  --annotate-with-trace\n");
+        fmt::print("  --no-mmap\n");
+        fmt::print("  --emit-cache FILE\n");
+        fmt::print("  --from-cache\n");
+        fmt::print("  --file-list FILE\n");
+        fmt::print("  --jobs NUMBER\n");
         fmt::print("  --help\n");
         fmt::print("  --version\n");
         fmt::print("Available analyses:\n");
@@ -134,7 +327,9 @@ int main(int argc, const char* argv[])
         fmt::print("Version: {}\n", version);
     };
 
-    std::string_view file;
+    std::vector<std::string> files;
+    // A file list always runs in batch mode, even with a single file.
+    bool batch = false;
     Config config;
     for (int i = 1; i < argc; ++i)
     {
@@ -151,6 +346,28 @@ int main(int argc, const char* argv[])
                 config.dumpReverseCfg = true;
                 continue;
             }
+            if (argv[i] == "--dump-format"sv)
+            {
+                if (i == argc - 1 || argv[i+1][0] == '-')
+                {
+                    fmt::print(stderr, "Dump format was not provided.");
+                    return EXIT_FAILURE;
+                }
+                auto format = parseCfgFormat(argv[i+1]);
+                if (!format)
+                {
+                    fmt::print(stderr, "Invalid dump format '{}'.", argv[i+1]);
+                    return EXIT_FAILURE;
+                }
+                config.dumpFormat = *format;
+                ++i;
+                continue;
+            }
+            if (argv[i] == "--simplify-cfg"sv)
+            {
+                config.simplifyCfg = true;
+                continue;
+            }
             if (argv[i] == "--svg"sv)
             {
                 config.svg = true;
@@ -166,6 +383,27 @@ int main(int argc, const char* argv[])
                 config.annotateTrace = true;
                 continue;
             }
+            if (argv[i] == "--no-mmap"sv)
+            {
+                config.mmapInput = false;
+                continue;
+            }
+            if (argv[i] == "--from-cache"sv)
+            {
+                config.fromCache = true;
+                continue;
+            }
+            if (argv[i] == "--emit-cache"sv)
+            {
+                if (i == argc - 1)
+                {
+                    fmt::print(stderr, "Cache file was not provided.");
+                    return EXIT_FAILURE;
+                }
+                config.cacheOutput = argv[i+1];
+                ++i;
+                continue;
+            }
             if (argv[i] == "--help"sv || argv[i] == "--version"sv)
             {
                 printHelp();
@@ -204,6 +442,41 @@ int main(int argc, const char* argv[])
                 ++i;
                 continue;
             }
+            if (argv[i] == "--jobs"sv)
+            {
+                if (i == argc - 1 || argv[i+1][0] == '-')
+                {
+                    fmt::print(stderr, "Job count was not provided.");
+                    return EXIT_FAILURE;
+                }
+                auto nextNum = toInt(argv[i+1]);
+                if (!nextNum || *nextNum < 1)
+                {
+                    fmt::print(stderr, "Invalid job count.");
+                    return EXIT_FAILURE;
+                }
+                config.jobs = *nextNum;
+                ++i;
+                continue;
+            }
+            if (argv[i] == "--file-list"sv)
+            {
+                if (i == argc - 1)
+                {
+                    fmt::print(stderr, "File list was not provided.");
+                    return EXIT_FAILURE;
+                }
+                auto listed = readFileList(argv[i+1]);
+                if (!listed)
+                {
+                    fmt::print(stderr, "Unable to open file list '{}'.", argv[i+1]);
+                    return EXIT_FAILURE;
+                }
+                files.insert(files.end(), listed->begin(), listed->end());
+                batch = true;
+                ++i;
+                continue;
+            }
             if (argv[i] == "--loopiness"sv)
             {
                 if (i == argc - 1 || argv[i+1][0] == '-')
@@ -225,26 +498,32 @@ int main(int argc, const char* argv[])
             printHelp();
             return EXIT_FAILURE;
         }
-        if (file.empty())
-        {
-            file = argv[i];
-            continue;
-        }
-
-        fmt::print(stderr, "error: multiple input files specified.\n");
-        printHelp();
-        return EXIT_FAILURE;
+        files.emplace_back(argv[i]);
     }
 
     if (config.dotsOnly && !config.svg)
         fmt::print(stderr, "warning: --dots-only is redundant without --svg.\n");
+    if (config.dumpFormat && !config.dumpCfg && !config.dumpReverseCfg)
+        fmt::print(stderr, "warning: --dump-format is redundant without --cfg-dump or --reverse-cfg-dump.\n");
 
-    if (file.empty())
+    if (files.empty())
     {
         fmt::print(stderr, "error: input file not specified.\n");
         printHelp();
         return EXIT_FAILURE;
     }
 
-    return runFile(file, config) ? EXIT_SUCCESS : EXIT_FAILURE;
+    if (config.cacheOutput && (batch || files.size() > 1))
+    {
+        fmt::print(stderr, "error: --emit-cache needs a single input file.\n");
+        return EXIT_FAILURE;
+    }
+    if (config.cacheOutput && config.fromCache)
+        fmt::print(stderr, "warning: --emit-cache is ignored with --from-cache.\n");
+
+    if (batch || files.size() > 1)
+        return runBatch(files, config) ? EXIT_SUCCESS : EXIT_FAILURE;
+
+    FileOutput output{std::cout, std::cerr, 0, STDOUT_FILENO};
+    return runFile(files.front(), config, output) ? EXIT_SUCCESS : EXIT_FAILURE;
 }
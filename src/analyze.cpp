@@ -46,6 +46,24 @@ std::unordered_map<std::string_view, AnalysisResultsFunc<CFG>> forwardAnalyses =
                                 intervalAnalysisToOperationAnnotations,
                                 intervalAnalysisToCoveredArea>
     },
+    {
+        "interval-narrowed", &getResults<CFG, Vec2Interval,
+                                         getNarrowedIntervalAnalysis,
+                                         intervalAnalysisToOperationAnnotations,
+                                         intervalAnalysisToCoveredArea>
+    },
+    {
+        "interval-wto", &getResults<CFG, Vec2Interval,
+                                    getWtoIntervalAnalysis,
+                                    intervalAnalysisToOperationAnnotations,
+                                    intervalAnalysisToCoveredArea>
+    },
+    {
+        "interval-scc", &getResults<CFG, Vec2Interval,
+                                    getSccIntervalAnalysis,
+                                    intervalAnalysisToOperationAnnotations,
+                                    intervalAnalysisToCoveredArea>
+    },
     {
         "past-operations", &getResults<CFG, StringSetDomain,
                                 getPastOperationsAnalysis,
@@ -54,9 +72,11 @@ std::unordered_map<std::string_view, AnalysisResultsFunc<CFG>> forwardAnalyses =
     }
 };
 
-std::unordered_map<std::string_view, AnalysisResultsFunc<ReverseCFG>> backwardAnalyses = {
+// The backward analyses run on the materialized reverse CFG, it is faster to
+// traverse than the views of ReverseCFG.
+std::unordered_map<std::string_view, AnalysisResultsFunc<MaterializedReverseCFG>> backwardAnalyses = {
     {
-        "future-operations", &getResults<ReverseCFG, StringSetDomain,
+        "future-operations", &getResults<MaterializedReverseCFG, StringSetDomain,
                                 getFutureOperationsAnalysis,
                                 futureOperationsAnalysisToOperationAnnotations,
                                 futureOperationsAnalysisToCoveredArea>
@@ -72,7 +92,7 @@ std::optional<AnalysisResult> getAnalysisResults(std::string_view analysisName,
 
     if (auto it = backwardAnalyses.find(analysisName); it != backwardAnalyses.end())
     {
-        ReverseCFG revCfg(cfg);
+        MaterializedReverseCFG revCfg(cfg);
         return it->second(revCfg);
     }
 
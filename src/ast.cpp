@@ -1,10 +1,10 @@
 #include "include/ast.h"
 
+#include "include/flat_ast.h"
+
 #include <sstream>
 #include <fmt/format.h>
 
-void print(int indent, Node n, std::ostream& output, const Annotations& anns) noexcept;
-
 namespace
 {
     std::string indentString(int n)
@@ -38,64 +38,154 @@ namespace
         renderAnnotations(out, n, anns.postAnnotations);
     }
 
+    // A loop, branch or sequence whose children are being printed.
+    template<typename Tree>
+    struct OpenNode
+    {
+        typename Tree::NodeRef node;
+        int indent;
+        // The number of children started so far.
+        std::size_t next = 0;
+    };
+
     struct NodePrinter {
         void operator()(const Init* i) const noexcept
         {
-            out << fmt::format("init({}, {}, {}, {})", *i->topX.value, *i->topY.value, *i->width.value, *i->height.value);
+            out << fmt::format("init({}, {}, {}, {})", i->topX, i->topY, i->width, i->height);
         }
         void operator()(const Translation* t) const noexcept
         {
-            out << fmt::format("translation({}, {})", *t->x.value, *t->y.value);
+            out << fmt::format("translation({}, {})", t->x, t->y);
         }
         void operator()(const Rotation* r) const noexcept
         {
-            out << fmt::format("rotation({}, {}, {})", *r->x.value, *r->y.value, *r->deg.value);
+            out << fmt::format("rotation({}, {}, {})", r->x, r->y, r->deg);
         }
-        void operator()(const Sequence* s) const noexcept
+        // The nodes with children are finished by printTree().
+        void operator()(const Sequence*) const noexcept {}
+        void operator()(const Branch*) const noexcept {}
+        void operator()(const Loop*) const noexcept {}
+
+        std::ostream& out;
+    };
+
+    bool isOperation(NodeKind kind) noexcept
+    {
+        return kind == NodeKind::Init || kind == NodeKind::Translation || kind == NodeKind::Rotation;
+    }
+
+    // The nodes of a FlatAST other than the operations have no Node, they
+    // cannot be annotated.
+    template<typename Tree>
+    void renderAnnotations(std::ostream& out, const Tree& tree, typename Tree::NodeRef n,
+                           const Annotations& anns, bool pre) noexcept
+    {
+        if constexpr (std::is_same_v<typename Tree::NodeRef, NodeId>)
         {
-            int i = 0;
-            const int size = s->nodes.size();
-            for (auto n : s->nodes)
-            {
-                print(indent, n, out, anns);
-                if (i++ < size - 1)
-                    out << ";\n";
-            }
+            if (!isOperation(tree.kind(n)))
+                return;
         }
-        void operator()(const Branch* b) const noexcept
+        if (pre)
+            renderPreAnnotations(out, tree.getNode(n), anns);
+        else
+            renderPostAnnotations(out, tree.getNode(n), anns);
+    }
+
+    template<typename Tree>
+    void startNode(const Tree& tree, int indent, typename Tree::NodeRef n, std::ostream& out,
+                   const Annotations& anns, std::vector<OpenNode<Tree>>& stack) noexcept
+    {
+        const NodeKind kind = tree.kind(n);
+        if (kind != NodeKind::Sequence)
+            out << indentString(indent);
+        renderAnnotations(out, tree, n, anns, /*pre =*/true);
+        if (isOperation(kind))
         {
-            out << "{\n";
-            print(indent + 2, b->lhs, out, anns);
-            out << "\n" << indentString(indent) << "} or {\n";
-            print(indent + 2, b->rhs, out, anns);
-            out << "\n" << indentString(indent) << "}";
+            std::visit(NodePrinter{out}, tree.getNode(n));
+            renderAnnotations(out, tree, n, anns, /*pre =*/false);
         }
-        void operator()(const Loop* l) const noexcept
+        else
+            stack.push_back({n, indent});
+    }
+
+    // Uses an explicit stack instead of recursion, the native stack usage
+    // does not depend on the nesting depth of the program.
+    template<typename Tree>
+    std::string printTree(const Tree& tree, typename Tree::NodeRef n, const Annotations& anns) noexcept
+    {
+        std::stringstream out;
+        std::vector<OpenNode<Tree>> stack;
+        startNode(tree, 0, n, out, anns, stack);
+        while (!stack.empty())
         {
-            out << "iter {\n";
-            print(indent + 2, l->body, out, anns);
-            out << "\n" << indentString(indent) << "}";
+            // The reference is invalidated when a child is started.
+            OpenNode<Tree>& top = stack.back();
+            const auto node = top.node;
+            const int indent = top.indent;
+            const std::size_t child = top.next++;
+            bool finished = false;
+            switch (tree.kind(node))
+            {
+            case NodeKind::Sequence:
+            {
+                const auto children = tree.children(node);
+                if (child < children.size())
+                {
+                    if (child > 0)
+                        out << ";\n";
+                    startNode(tree, indent, children[child], out, anns, stack);
+                }
+                else
+                    finished = true;
+                break;
+            }
+            case NodeKind::Branch:
+                if (child == 0)
+                {
+                    out << "{\n";
+                    startNode(tree, indent + 2, tree.lhs(node), out, anns, stack);
+                }
+                else if (child == 1)
+                {
+                    out << "\n" << indentString(indent) << "} or {\n";
+                    startNode(tree, indent + 2, tree.rhs(node), out, anns, stack);
+                }
+                else
+                {
+                    out << "\n" << indentString(indent) << "}";
+                    finished = true;
+                }
+                break;
+            default:
+                if (child == 0)
+                {
+                    out << "iter {\n";
+                    startNode(tree, indent + 2, tree.body(node), out, anns, stack);
+                }
+                else
+                {
+                    out << "\n" << indentString(indent) << "}";
+                    finished = true;
+                }
+                break;
+            }
+
+            if (finished)
+            {
+                renderAnnotations(out, tree, node, anns, /*pre =*/false);
+                stack.pop_back();
+            }
         }
-        int indent;
-        std::ostream& out;
-        const Annotations& anns;
-    };
+        return std::move(out).str();
+    }
 } // anonymous namespace
 
 std::string print(Node n, const Annotations& anns) noexcept
 {
-    std::stringstream output;
-    print(0, n, output, anns);
-    return std::move(output).str();
+    return printTree(LinkedAST{}, n, anns);
 }
 
-
-void print(int indent, Node n, std::ostream& output, const Annotations& anns) noexcept
+std::string print(const FlatAST& ast, const Annotations& anns) noexcept
 {
-    if (!std::holds_alternative<const Sequence*>(n))
-        output << indentString(indent);
-    renderPreAnnotations(output, n, anns);
-    NodePrinter nodePrinter{indent, output, anns};
-    std::visit(nodePrinter, n);
-    renderPostAnnotations(output, n, anns);
+    return printTree(ast, ast.getRootId(), anns);
 }
@@ -0,0 +1,81 @@
+#include "include/block_mapping.h"
+
+#include <algorithm>
+#include <ranges>
+#include <tuple>
+#include <utility>
+
+namespace
+{
+bool equivalentOperations(const BasicBlock& lhs, const BasicBlock& rhs)
+{
+    return std::ranges::equal(lhs.operations(), rhs.operations(),
+                              [](Operation l, Operation r) { return l.isEquivalent(r); });
+}
+} // anonymous
+
+BlockMapping::BlockMapping(const CFG& before, const CFG& after)
+  : previousBlocks(after.blocks().size(), -1), previousSize(static_cast<int>(before.blocks().size()))
+{
+    const auto oldBlocks = before.blocks();
+    const auto newBlocks = after.blocks();
+    const int oldSize = static_cast<int>(oldBlocks.size());
+    const int newSize = static_cast<int>(newBlocks.size());
+    const int common = std::min(oldSize, newSize);
+    int prefix = 0;
+    while (prefix < common && equivalentOperations(oldBlocks[prefix], newBlocks[prefix]))
+        ++prefix;
+    int suffix = 0;
+    while (suffix < common - prefix
+           && equivalentOperations(oldBlocks[oldSize - 1 - suffix], newBlocks[newSize - 1 - suffix]))
+        ++suffix;
+
+    // The candidate for a block before the edit.
+    const int shift = newSize - oldSize;
+    auto candidate = [&](int block) {
+        if (block < prefix)
+            return block;
+        return block >= oldSize - suffix ? block + shift : -1;
+    };
+    auto sameEdges = [&](std::span<const int> oldEdges, std::span<const int> newEdges) {
+        return std::ranges::equal(oldEdges, newEdges, [&](int o, int n) { return candidate(o) == n; });
+    };
+    previousBlocksBySuccessors = previousBlocks;
+    for (int block = 0; block < newSize; ++block)
+    {
+        const int old = block < prefix ? block : block >= newSize - suffix ? block - shift : -1;
+        if (old >= 0 && sameEdges(oldBlocks[old].predecessors(), newBlocks[block].predecessors()))
+            previousBlocks[block] = old;
+        else
+            changed.push_back(block);
+        if (old >= 0 && sameEdges(oldBlocks[old].successors(), newBlocks[block].successors()))
+            previousBlocksBySuccessors[block] = old;
+        else
+            changedBySuccessors.push_back(block);
+    }
+}
+
+BlockMapping BlockMapping::reversed() const
+{
+    // The ReverseCFG numbers the blocks from the end.
+    const int size = static_cast<int>(previousBlocks.size());
+    auto reverse = [&](const std::vector<int>& previous, const std::vector<int>& changedBlocks) {
+        std::vector<int> reversedPrevious(size);
+        for (int block = 0; block < size; ++block)
+        {
+            const int old = previous[size - 1 - block];
+            reversedPrevious[block] = old >= 0 ? previousSize - 1 - old : -1;
+        }
+        std::vector<int> reversedChanged;
+        reversedChanged.reserve(changedBlocks.size());
+        for (int block : changedBlocks | std::views::reverse)
+            reversedChanged.push_back(size - 1 - block);
+        return std::pair{std::move(reversedPrevious), std::move(reversedChanged)};
+    };
+    BlockMapping result;
+    result.previousSize = previousSize;
+    // The successors in the ReverseCFG are the predecessors in the CFG.
+    std::tie(result.previousBlocks, result.changed) = reverse(previousBlocksBySuccessors, changedBySuccessors);
+    std::tie(result.previousBlocksBySuccessors, result.changedBySuccessors) = reverse(previousBlocks, changed);
+    return result;
+}
@@ -0,0 +1,433 @@
+#include "include/cache.h"
+
+#include <cstring>
+#include <fstream>
+#include <type_traits>
+
+namespace
+{
+// The node records are stored as they are.
+static_assert(std::is_trivially_copyable_v<Init> && sizeof(Init) == 5 * sizeof(std::uint32_t));
+static_assert(std::is_trivially_copyable_v<Translation> && sizeof(Translation) == 3 * sizeof(std::uint32_t));
+static_assert(std::is_trivially_copyable_v<Rotation> && sizeof(Rotation) == 4 * sizeof(std::uint32_t));
+
+// The number of elements of the arrays in the image, the arrays follow the
+// header in this order. The tokens have a type and an offset, the numbers
+// a value and a token id. The blocks have their sizes, and their RPO
+// position, preorder position, DFS parent and loop header flag.
+enum Section
+{
+    Inits, Translations, Rotations, Sequences, Branches, Loops, Children,
+    Tokens, Numbers, LineStarts, FileNameBytes, Blocks, Operations, Successors, Predecessors,
+    ReachableBlocks, BackEdges,
+    SectionCount
+};
+
+struct Header
+{
+    std::uint32_t magic;
+    std::uint32_t version;
+    std::uint32_t sizes[SectionCount];
+};
+
+// Every array starts at a multiple of the alignment.
+constexpr std::size_t Alignment = 8;
+
+constexpr std::size_t padded(std::size_t size) noexcept
+{
+    return (size + Alignment - 1) / Alignment * Alignment;
+}
+
+class Writer
+{
+public:
+    template<typename T>
+    void put(const T& value)
+    {
+        putArray(std::span(&value, 1));
+    }
+
+    template<typename T>
+    void putArray(std::span<const T> values)
+    {
+        static_assert(alignof(T) <= Alignment);
+        out.append(reinterpret_cast<const char*>(values.data()), values.size_bytes());
+        out.append(padded(values.size_bytes()) - values.size_bytes(), '\0');
+    }
+
+    std::string out;
+};
+
+class Reader
+{
+public:
+    explicit Reader(std::string_view image) : image(image) {}
+
+    template<typename T>
+    bool get(T& value)
+    {
+        static_assert(std::is_trivially_copyable_v<T>);
+        auto bytes = getArray<char>(sizeof(T));
+        if (bytes)
+            std::memcpy(&value, bytes->data(), sizeof(T));
+        return bytes.has_value();
+    }
+
+    // A view of the next array in the image.
+    template<typename T>
+    std::optional<std::span<const T>> getArray(std::size_t count)
+    {
+        static_assert(alignof(T) <= Alignment);
+        const std::size_t bytes = count * sizeof(T);
+        if (image.size() - pos < padded(bytes))
+            return {};
+        std::span<const T> result(reinterpret_cast<const T*>(image.data() + pos), count);
+        pos += padded(bytes);
+        return result;
+    }
+
+    bool atEnd() const noexcept { return pos == image.size(); }
+
+private:
+    std::string_view image;
+    std::size_t pos = 0;
+};
+
+static_assert(std::is_trivially_copyable_v<FlatSequence> && sizeof(FlatSequence) == 2 * sizeof(std::uint32_t));
+static_assert(std::is_trivially_copyable_v<FlatBranch> && sizeof(FlatBranch) == 3 * sizeof(std::uint32_t));
+static_assert(std::is_trivially_copyable_v<FlatLoop> && sizeof(FlatLoop) == 2 * sizeof(std::uint32_t));
+static_assert(std::is_trivially_copyable_v<NodeId> && sizeof(NodeId) == sizeof(std::uint32_t));
+static_assert(std::is_trivially_copyable_v<Operation> && sizeof(Operation) == 6 * sizeof(std::uint32_t));
+static_assert(sizeof(std::pair<int, int>) == 2 * sizeof(int));
+
+// The operation the CFG builder creates for the Init, Translation or
+// Rotation node.
+Operation encode(const FlatAST& ast, NodeId id) noexcept
+{
+    switch (id.kind())
+    {
+    case NodeKind::Init:
+        return Operation(&ast.getInits()[id.index()], id);
+    case NodeKind::Translation:
+        return Operation(&ast.getTranslations()[id.index()], id);
+    case NodeKind::Rotation:
+        return Operation(&ast.getRotations()[id.index()], id);
+    default:
+        return {};
+    }
+}
+
+// The DFS tree is trusted as long as it is a numbering of the blocks that
+// is consistent with the edges: the back edges are the edges that do not go
+// forward in RPO, and their targets are the loop headers.
+bool isConsistentDfsTree(const CFG& cfg)
+{
+    const DfsTree& dfs = cfg.dfsTree();
+    const auto blocks = cfg.blocks();
+    const std::size_t reachable = dfs.rpoBlocks().size();
+    if (reachable == 0 || dfs.rpoBlocks().front() != 0 || dfs.parent(0) != -1)
+        return false;
+    // Every RPO position and every preorder position is used once.
+    std::vector<bool> rpoUsed(blocks.size(), false);
+    std::vector<bool> preorderUsed(reachable, false);
+    for (std::size_t block = 0; block < blocks.size(); ++block)
+    {
+        const int position = dfs.rpoPosition(block);
+        const int preorder = dfs.preorderPosition(block);
+        const int parent = dfs.parent(block);
+        if (position < 0 || static_cast<std::size_t>(position) >= blocks.size() || rpoUsed[position])
+            return false;
+        rpoUsed[position] = true;
+        if (preorder < 0)
+        {
+            if (preorder != -1 || static_cast<std::size_t>(position) < reachable || parent != -1)
+                return false;
+            continue;
+        }
+        if (static_cast<std::size_t>(preorder) >= reachable || preorderUsed[preorder] ||
+            static_cast<std::size_t>(position) >= reachable || dfs.rpoBlocks()[position] != static_cast<int>(block))
+            return false;
+        preorderUsed[preorder] = true;
+        // The parents come first in both orders.
+        if (block != 0 && (parent < 0 || static_cast<std::size_t>(parent) >= blocks.size() ||
+                           dfs.preorderPosition(parent) < 0 || dfs.preorderPosition(parent) >= preorder ||
+                           dfs.rpoPosition(parent) >= position))
+            return false;
+    }
+
+    std::vector<bool> headers(blocks.size(), false);
+    auto backEdge = dfs.backEdges().begin();
+    for (int block : dfs.rpoBlocks())
+    {
+        for (int succ : blocks[block].successors())
+        {
+            if (!dfs.isReachable(succ))
+                return false;
+            if (!dfs.isBackEdge(block, succ))
+            {
+                if (dfs.rpoPosition(succ) <= dfs.rpoPosition(block))
+                    return false;
+                continue;
+            }
+            if (backEdge == dfs.backEdges().end() || *backEdge++ != std::pair(block, succ))
+                return false;
+            headers[succ] = true;
+        }
+    }
+    if (backEdge != dfs.backEdges().end())
+        return false;
+    for (std::size_t block = 0; block < blocks.size(); ++block)
+    {
+        if (dfs.isLoopHeader(block) != headers[block])
+            return false;
+    }
+    return true;
+}
+} // anonymous namespace
+
+std::string ProgramCache::serialize(const FlatAST& ast, const CFG& cfg)
+{
+    assert(std::ranges::all_of(cfg.operations, &Operation::hasNodeId));
+    Header header{Magic, Version, {}};
+    const LocationTable& locations = ast.tokens.getLocations();
+    const DfsTree& dfs = cfg.dfsTree();
+    header.sizes[Inits] = ast.inits.size();
+    header.sizes[Translations] = ast.translations.size();
+    header.sizes[Rotations] = ast.rotations.size();
+    header.sizes[Sequences] = ast.sequences.size();
+    header.sizes[Branches] = ast.branches.size();
+    header.sizes[Loops] = ast.loops.size();
+    header.sizes[Children] = ast.sequenceChildren.size();
+    header.sizes[Tokens] = ast.tokens.size();
+    header.sizes[Numbers] = ast.tokens.numbers.size();
+    header.sizes[LineStarts] = locations.getLineStarts().size();
+    header.sizes[FileNameBytes] = locations.getFile().size();
+    header.sizes[Blocks] = cfg.blocks().size();
+    header.sizes[Operations] = cfg.operations.size();
+    header.sizes[Successors] = cfg.successorIds.size();
+    header.sizes[Predecessors] = cfg.predecessorIds.size();
+    header.sizes[ReachableBlocks] = dfs.blocksInRpo.size();
+    header.sizes[BackEdges] = dfs.backEdgeList.size();
+
+    std::vector<CFG::BlockSizes> blocks;
+    blocks.reserve(cfg.blocks().size());
+    for (const auto& block : cfg.blocks())
+    {
+        blocks.push_back({static_cast<std::uint32_t>(block.operations().size()),
+                          static_cast<std::uint32_t>(block.successors().size()),
+                          static_cast<std::uint32_t>(block.predecessors().size())});
+    }
+
+    Writer writer;
+    writer.put(header);
+    writer.putArray(std::span(ast.inits));
+    writer.putArray(std::span(ast.translations));
+    writer.putArray(std::span(ast.rotations));
+    writer.putArray(std::span(ast.sequences));
+    writer.putArray(std::span(ast.branches));
+    writer.putArray(std::span(ast.loops));
+    writer.putArray(std::span(ast.sequenceChildren));
+    writer.putArray(std::span(ast.tokens.types));
+    writer.putArray(std::span(ast.tokens.offsets));
+    writer.putArray(std::span(ast.tokens.numbers));
+    writer.putArray(std::span(ast.tokens.numberIds));
+    writer.putArray(locations.getLineStarts());
+    writer.putArray(std::span(locations.getFile()));
+    writer.putArray(std::span<const CFG::BlockSizes>(blocks));
+    writer.putArray(std::span(cfg.operations));
+    writer.putArray(std::span(cfg.successorIds));
+    writer.putArray(std::span(cfg.predecessorIds));
+    writer.putArray(std::span(dfs.rpoOrder));
+    writer.putArray(std::span(dfs.blocksInRpo));
+    writer.putArray(std::span(dfs.preorder));
+    writer.putArray(std::span(dfs.parents));
+    writer.putArray(std::span(dfs.backEdgeList));
+    writer.putArray(std::span(dfs.loopHeaders));
+    return std::move(writer.out);
+}
+
+bool ProgramCache::write(std::string_view path, const FlatAST& ast, const CFG& cfg)
+{
+    std::ofstream out(std::string(path), std::ios::binary);
+    std::string image = serialize(ast, cfg);
+    out.write(image.data(), static_cast<std::streamsize>(image.size()));
+    return static_cast<bool>(out);
+}
+
+std::optional<CachedProgram> ProgramCache::deserialize(std::string_view image)
+{
+    if (reinterpret_cast<std::uintptr_t>(image.data()) % Alignment != 0)
+        return {};
+    Reader reader(image);
+    Header header;
+    if (!reader.get(header) || header.magic != Magic || header.version != Version)
+        return {};
+
+    auto inits = reader.getArray<Init>(header.sizes[Inits]);
+    auto translations = reader.getArray<Translation>(header.sizes[Translations]);
+    auto rotations = reader.getArray<Rotation>(header.sizes[Rotations]);
+    auto sequences = reader.getArray<FlatSequence>(header.sizes[Sequences]);
+    auto branches = reader.getArray<FlatBranch>(header.sizes[Branches]);
+    auto loops = reader.getArray<FlatLoop>(header.sizes[Loops]);
+    auto children = reader.getArray<NodeId>(header.sizes[Children]);
+    auto types = reader.getArray<TokenType>(header.sizes[Tokens]);
+    auto offsets = reader.getArray<std::uint32_t>(header.sizes[Tokens]);
+    auto numbers = reader.getArray<int>(header.sizes[Numbers]);
+    auto numberIds = reader.getArray<TokenId>(header.sizes[Numbers]);
+    auto lineStarts = reader.getArray<std::uint32_t>(header.sizes[LineStarts]);
+    auto fileName = reader.getArray<char>(header.sizes[FileNameBytes]);
+    auto blocks = reader.getArray<CFG::BlockSizes>(header.sizes[Blocks]);
+    auto operations = reader.getArray<Operation>(header.sizes[Operations]);
+    auto successors = reader.getArray<int>(header.sizes[Successors]);
+    auto predecessors = reader.getArray<int>(header.sizes[Predecessors]);
+    auto rpoOrder = reader.getArray<int>(header.sizes[Blocks]);
+    auto blocksInRpo = reader.getArray<int>(header.sizes[ReachableBlocks]);
+    auto preorder = reader.getArray<int>(header.sizes[Blocks]);
+    auto parents = reader.getArray<int>(header.sizes[Blocks]);
+    auto backEdges = reader.getArray<std::pair<int, int>>(header.sizes[BackEdges]);
+    auto loopHeaders = reader.getArray<std::uint8_t>(header.sizes[Blocks]);
+    if (!inits || !translations || !rotations || !sequences || !branches || !loops || !children ||
+        !types || !offsets || !numbers || !numberIds || !lineStarts || !fileName ||
+        !blocks || !operations || !successors || !predecessors ||
+        !rpoOrder || !blocksInRpo || !preorder || !parents || !backEdges || !loopHeaders || !reader.atEnd())
+        return {};
+
+    FlatAST ast;
+    ast.inits = MappableVector<Init>::view(*inits);
+    ast.translations = MappableVector<Translation>::view(*translations);
+    ast.rotations = MappableVector<Rotation>::view(*rotations);
+    ast.sequences = MappableVector<FlatSequence>::view(*sequences);
+    ast.branches = MappableVector<FlatBranch>::view(*branches);
+    ast.loops = MappableVector<FlatLoop>::view(*loops);
+    ast.sequenceChildren = MappableVector<NodeId>::view(*children);
+
+    if (ast.sequences.empty() || lineStarts->empty() || lineStarts->front() != 0 ||
+        !std::ranges::is_sorted(*lineStarts))
+        return {};
+    // The number values are looked up by binary search on the ids of the
+    // NUMBER tokens.
+    auto nextNumber = numberIds->begin();
+    for (TokenId id = 0; id < types->size(); ++id)
+    {
+        if ((*types)[id] > TokenType::END_OF_FILE)
+            return {};
+        if ((*types)[id] == TokenType::NUMBER && (nextNumber == numberIds->end() || *nextNumber++ != id))
+            return {};
+    }
+    if (nextNumber != numberIds->end())
+        return {};
+    TokenBuffer& tokens = ast.tokens;
+    tokens.types = MappableVector<TokenType>::view(*types);
+    tokens.offsets = MappableVector<std::uint32_t>::view(*offsets);
+    tokens.numbers = MappableVector<int>::view(*numbers);
+    tokens.numberIds = MappableVector<TokenId>::view(*numberIds);
+    LocationTable locations{std::string(fileName->begin(), fileName->end())};
+    locations.lineStarts = MappableVector<std::uint32_t>::view(*lineStarts);
+    tokens.setLocations(std::move(locations));
+
+    // Validate every reference, the nodes are only accessed through them
+    // without further checks.
+    auto validToken = [&](TokenId id) { return id < tokens.size(); };
+    auto validNode = [&](NodeId id) -> bool {
+        switch (id.kind())
+        {
+        case NodeKind::Init: return id.index() < ast.inits.size();
+        case NodeKind::Translation: return id.index() < ast.translations.size();
+        case NodeKind::Rotation: return id.index() < ast.rotations.size();
+        case NodeKind::Branch: return id.index() < ast.branches.size();
+        case NodeKind::Loop: return id.index() < ast.loops.size();
+        // Sequences are never children of sequences.
+        default: return false;
+        }
+    };
+    for (const auto& init : ast.inits)
+        if (!validToken(init.kw)) return {};
+    for (const auto& translation : ast.translations)
+        if (!validToken(translation.kw)) return {};
+    for (const auto& rotation : ast.rotations)
+        if (!validToken(rotation.kw)) return {};
+    for (const auto& branch : ast.branches)
+        if (!validToken(branch.kw) || branch.lhs >= ast.sequences.size() || branch.rhs >= ast.sequences.size()) return {};
+    for (const auto& loop : ast.loops)
+        if (!validToken(loop.kw) || loop.body >= ast.sequences.size()) return {};
+    for (std::size_t i = 0; i < ast.sequences.size(); ++i)
+    {
+        auto [first, count] = ast.sequences[i];
+        if (std::size_t{first} + count > ast.sequenceChildren.size())
+            return {};
+        for (NodeId id : std::span(ast.sequenceChildren).subspan(first, count))
+        {
+            if (!validNode(id))
+                return {};
+            // The sequences are in preorder, so the nested sequences always
+            // come later. This rules out cycles.
+            if (id.kind() == NodeKind::Branch &&
+                (ast.branches[id.index()].lhs <= i || ast.branches[id.index()].rhs <= i))
+                return {};
+            if (id.kind() == NodeKind::Loop && ast.loops[id.index()].body <= i)
+                return {};
+        }
+    }
+
+    if (blocks->empty())
+        return {};
+    std::size_t operationCount = 0;
+    std::size_t successorCount = 0;
+    std::size_t predecessorCount = 0;
+    for (const auto& block : *blocks)
+    {
+        operationCount += block.ops;
+        successorCount += block.succs;
+        predecessorCount += block.preds;
+    }
+    if (operationCount != operations->size() || successorCount != successors->size() ||
+        predecessorCount != predecessors->size())
+        return {};
+    for (Operation op : *operations)
+    {
+        if (!op.hasNodeId() || !validNode(op.getNodeId()) || op.getNodeId().kind() > NodeKind::Rotation)
+            return {};
+        // The kind and the immediates are stored next to the id, they have
+        // to match the node.
+        const Operation expected = encode(ast, op.getNodeId());
+        if (op != expected || !op.isEquivalent(expected))
+            return {};
+    }
+    auto validBlock = [&](int block) { return block >= 0 && static_cast<std::size_t>(block) < blocks->size(); };
+    if (!std::ranges::all_of(*successors, validBlock) || !std::ranges::all_of(*predecessors, validBlock))
+        return {};
+
+    CFG cfg;
+    cfg.operations = MappableVector<Operation>::view(*operations);
+    cfg.successorIds = MappableVector<int>::view(*successors);
+    cfg.predecessorIds = MappableVector<int>::view(*predecessors);
+    cfg.flatNodes = {ast.getInits(), ast.getTranslations(), ast.getRotations()};
+    DfsTree dfs;
+    dfs.rpoOrder = MappableVector<int>::view(*rpoOrder);
+    dfs.blocksInRpo = MappableVector<int>::view(*blocksInRpo);
+    dfs.preorder = MappableVector<int>::view(*preorder);
+    dfs.parents = MappableVector<int>::view(*parents);
+    dfs.backEdgeList = MappableVector<std::pair<int, int>>::view(*backEdges);
+    dfs.loopHeaders = MappableVector<std::uint8_t>::view(*loopHeaders);
+    cfg.setBlockRanges(*blocks, std::move(dfs));
+    if (!isConsistentDfsTree(cfg))
+        return {};
+
+    return CachedProgram{std::move(ast), std::move(cfg)};
+}
+
+std::optional<CachedProgram> ProgramCache::load(SourceFile file)
+{
+    auto program = deserialize(file.content());
+    if (program)
+        program->file.emplace(std::move(file));
+    return program;
+}
+
+std::optional<CachedProgram> ProgramCache::load(std::string_view path)
+{
+    auto file = SourceFile::open(path);
+    if (!file)
+        return {};
+    return load(std::move(*file));
+}
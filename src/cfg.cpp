@@ -1,87 +1,536 @@
 #include "include/cfg.h"
 
+#include "include/flat_ast.h"
 
-int CFG::addAstNode(int currentBlock, Node currentNode)
+
+namespace
+{
+// A loop, branch or sequence whose children are being added to the CFG.
+template<typename Tree>
+struct OpenNode
+{
+    typename Tree::NodeRef node;
+    // The number of children started so far.
+    std::size_t next = 0;
+    // Branches: the block before the branch and the first blocks of the
+    // alternatives. Loops: the first block of the body in `lhs`.
+    int before = 0;
+    int lhs = 0;
+    int rhs = 0;
+    int lhsEnd = 0;
+};
+
+// Replaces `old` in `ids` with the `replacements` that are not in `ids` yet,
+// keeping the order of the edges.
+void replaceId(std::vector<int>& ids, int old, std::span<const int> replacements)
 {
-    struct
+    auto it = std::ranges::find(ids, old);
+    assert(it != ids.end());
+    it = ids.erase(it);
+    for (int id : replacements)
     {
-        int currentBlock;
-        CFG& cfg;
+        if (std::ranges::find(ids, id) == ids.end())
+            it = std::next(ids.insert(it, id));
+    }
+}
+
+// The operations of a FlatAST refer to their nodes by id.
+template<typename T>
+Operation makeOperation(const LinkedAST&, Node, const T* node) noexcept
+{
+    return Operation(node);
+}
 
-        int operator()(const Init* i) noexcept
+template<typename T>
+Operation makeOperation(const FlatAST&, NodeId id, const T* node) noexcept
+{
+    return Operation(node, id);
+}
+
+// Reports the blocks, the operations and the edges of the CFG of the AST to
+// the sink, always in the same order. The first block is the start block.
+// Uses an explicit stack instead of recursion, the native stack usage does
+// not depend on the nesting depth of the program.
+template<typename Sink, typename Tree>
+void addAstNode(Sink& cfg, const Tree& tree, typename Tree::NodeRef root)
+{
+    int currentBlock = cfg.newBlock();
+    std::vector<OpenNode<Tree>> stack;
+    auto startNode = [&](typename Tree::NodeRef n) {
+        switch (tree.kind(n))
         {
-            cfg.basicBlocks[currentBlock].ops.emplace_back(i);
-            return currentBlock;
-        }
-        int operator()(const Translation* t) noexcept
+        case NodeKind::Init:
+        case NodeKind::Translation:
+        case NodeKind::Rotation:
+            std::visit([&]<typename T>(const T* op) {
+                if constexpr (std::is_constructible_v<Operation, const T*>)
+                    cfg.addOperation(currentBlock, makeOperation(tree, n, op));
+            }, tree.getNode(n));
+            break;
+        case NodeKind::Sequence:
+            stack.push_back({n});
+            break;
+        case NodeKind::Branch:
         {
-            cfg.basicBlocks[currentBlock].ops.emplace_back(t);
-            return currentBlock;
+            int lhsBlock = cfg.newBlock();
+            int rhsBlock = cfg.newBlock();
+            stack.push_back({.node = n, .before = currentBlock, .lhs = lhsBlock, .rhs = rhsBlock});
+            break;
         }
-        int operator()(const Rotation* r) noexcept
+        case NodeKind::Loop:
         {
-            cfg.basicBlocks[currentBlock].ops.emplace_back(r);
-            return currentBlock;
+            int bodyBegin = cfg.newBlock();
+            cfg.addEdge(currentBlock, bodyBegin);
+            currentBlock = bodyBegin;
+            stack.push_back({.node = n, .lhs = bodyBegin});
+            break;
+        }
         }
-        int operator()(const Sequence* s) noexcept
+    };
+
+    startNode(root);
+    while (!stack.empty())
+    {
+        // The reference is invalidated when a child is started.
+        OpenNode<Tree>& top = stack.back();
+        const std::size_t child = top.next++;
+        switch (tree.kind(top.node))
         {
-            for (auto node : s->nodes)
+        case NodeKind::Sequence:
+        {
+            const auto children = tree.children(top.node);
+            if (child < children.size())
+                startNode(children[child]);
+            else
+                stack.pop_back();
+            break;
+        }
+        case NodeKind::Branch:
+            if (child == 0)
             {
-                currentBlock = cfg.addAstNode(currentBlock, node);
+                currentBlock = top.lhs;
+                startNode(tree.lhs(top.node));
             }
-            return currentBlock;
-        }
-        int operator()(const Branch* b) noexcept
-        {
-            int lhsBlock = cfg.newBlock();
-            int rhsBlock = cfg.newBlock();
-            int branchPred = currentBlock;
-            int lhsAfter = cfg.addAstNode(lhsBlock, b->lhs);
-            int rhsAfter = cfg.addAstNode(rhsBlock, b->rhs);
-            cfg.addEdge(branchPred, lhsBlock);
-            cfg.addEdge(branchPred, rhsBlock);
-            // TODO: can we do something smarter to avoid empty nodes with e.g., nested ors?
-            int afterBranch = cfg.newBlock();
-            cfg.addEdge(lhsAfter, afterBranch);
-            cfg.addEdge(rhsAfter, afterBranch);
-            return afterBranch;
+            else if (child == 1)
+            {
+                top.lhsEnd = currentBlock;
+                currentBlock = top.rhs;
+                startNode(tree.rhs(top.node));
+            }
+            else
+            {
+                cfg.addEdge(top.before, top.lhs);
+                cfg.addEdge(top.before, top.rhs);
+                // TODO: can we do something smarter to avoid empty nodes with e.g., nested ors?
+                int afterBranch = cfg.newBlock();
+                cfg.addEdge(top.lhsEnd, afterBranch);
+                cfg.addEdge(currentBlock, afterBranch);
+                currentBlock = afterBranch;
+                stack.pop_back();
+            }
+            break;
+        default:
+            if (child == 0)
+                startNode(tree.body(top.node));
+            else
+            {
+                int afterBody = cfg.newBlock();
+                cfg.addEdge(currentBlock, top.lhs);
+                cfg.addEdge(currentBlock, afterBody);
+                currentBlock = afterBody;
+                stack.pop_back();
+            }
+            break;
         }
-        int operator()(const Loop* l) noexcept
+    }
+}
+
+} // anonymous namespace
+
+struct CFG::SizeCounter
+{
+    int newBlock()
+    {
+        sizes.push_back({0, 0, 0});
+        return sizes.size() - 1;
+    }
+    void addOperation(int block, Operation) noexcept { ++sizes[block].ops; }
+    void addEdge(int from, int to) noexcept
+    {
+        ++sizes[from].succs;
+        ++sizes[to].preds;
+    }
+
+    std::vector<BlockSizes> sizes;
+};
+
+struct CFG::Filler
+{
+    // Sizes the arrays of the CFG, the ranges of the blocks follow each
+    // other in block order.
+    Filler(CFG& cfg, std::span<const BlockSizes> sizes) : cfg(cfg), next(sizes.size())
+    {
+        std::uint32_t op = 0;
+        std::uint32_t succ = 0;
+        std::uint32_t pred = 0;
+        for (std::size_t i = 0; i < sizes.size(); ++i)
         {
-            int bodyBegin = cfg.newBlock();
-            cfg.addEdge(currentBlock, bodyBegin);
-            int bodyEnd = cfg.addAstNode(bodyBegin, l->body);
-            int afterBody = cfg.newBlock();
-            cfg.addEdge(bodyEnd, bodyBegin);
-            cfg.addEdge(bodyEnd, afterBody);
-            return afterBody;
+            next[i] = {op, succ, pred};
+            op += sizes[i].ops;
+            succ += sizes[i].succs;
+            pred += sizes[i].preds;
         }
+        cfg.operations.resize(op);
+        cfg.successorIds.resize(succ);
+        cfg.predecessorIds.resize(pred);
+        operations = cfg.operations.mutableSpan();
+        successorIds = cfg.successorIds.mutableSpan();
+        predecessorIds = cfg.predecessorIds.mutableSpan();
+    }
+
+    int newBlock() noexcept { return blocks++; }
+    void addOperation(int block, Operation op) noexcept { operations[next[block].ops++] = op; }
+    void addEdge(int from, int to) noexcept
+    {
+        successorIds[next[from].succs++] = to;
+        predecessorIds[next[to].preds++] = from;
+    }
+
+    CFG& cfg;
+    std::span<Operation> operations;
+    std::span<int> successorIds;
+    std::span<int> predecessorIds;
+    // The position of the next entry of each block in the arrays.
+    std::vector<BlockSizes> next;
+    int blocks = 0;
+};
 
-    } processNode(currentBlock, *this);
-    
-    return std::visit(processNode, currentNode);
+template<typename Tree>
+CFG CFG::createCfg(const Tree& tree, typename Tree::NodeRef root) noexcept
+{
+    SizeCounter counter;
+    addAstNode(counter, tree, root);
+    CFG cfg;
+    Filler filler(cfg, counter.sizes);
+    addAstNode(filler, tree, root);
+    assert(filler.blocks == static_cast<int>(counter.sizes.size()));
+    cfg.setBlockRanges(counter.sizes);
+    return cfg;
 }
 
 CFG CFG::createCfg(Node root) noexcept
 {
-    CFG cfg;
-    // Add start block.
-    cfg.basicBlocks.emplace_back();
+    return createCfg(LinkedAST{}, root);
+}
 
-    cfg.addAstNode(0, root);
+CFG CFG::createCfg(const FlatAST& ast) noexcept
+{
+    CFG cfg = createCfg(ast, ast.getRootId());
+    cfg.flatNodes = {ast.getInits(), ast.getTranslations(), ast.getRotations()};
     return cfg;
 }
 
-CFG& CFG::addEdge(int from, int to)
+CFG::Builder& CFG::Builder::addEdge(int from, int to)
 {
-    basicBlocks[from].succs.push_back(to);
-    basicBlocks[to].preds.push_back(from);
+    blocks[from].succs.push_back(to);
+    blocks[to].preds.push_back(from);
     // TODO: add assertion that succs/preds has no duplicates.
     return *this;
 }
 
-int CFG::newBlock()
+int CFG::Builder::newBlock()
 {
-    basicBlocks.emplace_back();
-    return basicBlocks.size() - 1;
+    blocks.emplace_back();
+    return blocks.size() - 1;
+}
+
+CFG CFG::Builder::freeze() const
+{
+    CFG cfg;
+    std::vector<BlockSizes> sizes;
+    sizes.reserve(blocks.size());
+    std::size_t ops = 0;
+    std::size_t edges = 0;
+    for (const Block& block : blocks)
+    {
+        sizes.push_back({static_cast<std::uint32_t>(block.ops.size()),
+                         static_cast<std::uint32_t>(block.succs.size()),
+                         static_cast<std::uint32_t>(block.preds.size())});
+        ops += block.ops.size();
+        edges += block.succs.size();
+    }
+    cfg.operations.reserve(ops);
+    cfg.successorIds.reserve(edges);
+    cfg.predecessorIds.reserve(edges);
+    for (const Block& block : blocks)
+    {
+        cfg.operations.append(block.ops.begin(), block.ops.end());
+        cfg.successorIds.append(block.succs.begin(), block.succs.end());
+        cfg.predecessorIds.append(block.preds.begin(), block.preds.end());
+    }
+    cfg.setBlockRanges(sizes);
+    return cfg;
+}
+
+CFG CFG::reversed() const
+{
+    CFG result;
+    result.flatNodes = flatNodes;
+    const int last = basicBlocks.size() - 1;
+    std::vector<BlockSizes> sizes;
+    sizes.reserve(basicBlocks.size());
+    result.operations.reserve(operations.size());
+    result.successorIds.reserve(predecessorIds.size());
+    result.predecessorIds.reserve(successorIds.size());
+    for (const BasicBlock& block : std::views::reverse(basicBlocks))
+    {
+        sizes.push_back({static_cast<std::uint32_t>(block.ops.size()),
+                         static_cast<std::uint32_t>(block.preds.size()),
+                         static_cast<std::uint32_t>(block.succs.size())});
+        result.operations.append(block.ops.rbegin(), block.ops.rend());
+        for (int pred : block.preds)
+            result.successorIds.push_back(last - pred);
+        for (int succ : block.succs)
+            result.predecessorIds.push_back(last - succ);
+    }
+    result.setBlockRanges(sizes);
+    return result;
+}
+
+void CFG::setBlockRanges(std::span<const BlockSizes> sizes, std::optional<DfsTree> dfsTree)
+{
+    basicBlocks.resize(sizes.size());
+    std::size_t op = 0;
+    std::size_t succ = 0;
+    std::size_t pred = 0;
+    for (std::size_t i = 0; i < sizes.size(); ++i)
+    {
+        BasicBlock& block = basicBlocks[i];
+        block.ops = std::span<const Operation>(operations).subspan(op, sizes[i].ops);
+        block.succs = std::span<const int>(successorIds).subspan(succ, sizes[i].succs);
+        block.preds = std::span<const int>(predecessorIds).subspan(pred, sizes[i].preds);
+        op += sizes[i].ops;
+        succ += sizes[i].succs;
+        pred += sizes[i].preds;
+    }
+    assert(op == operations.size() && succ == successorIds.size() && pred == predecessorIds.size());
+    dfs = dfsTree ? std::move(*dfsTree) : DfsTree(*this);
+}
+
+Node CFG::getNode(Operation op) const noexcept
+{
+    if (!op.hasNodeId())
+        return op.toNode();
+    const NodeId id = op.getNodeId();
+    switch (id.kind())
+    {
+    case NodeKind::Init: return &flatNodes.inits[id.index()];
+    case NodeKind::Translation: return &flatNodes.translations[id.index()];
+    default: break;
+    }
+    return &flatNodes.rotations[id.index()];
+}
+
+SimplifiedCFG CFG::simplify() const
+{
+    const int blockCount = basicBlocks.size();
+    const int endBlock = blockCount - 1;
+    Builder builder;
+    builder.blocks.reserve(blockCount);
+    for (const BasicBlock& block : basicBlocks)
+    {
+        builder.blocks.push_back({{block.ops.begin(), block.ops.end()},
+                                  {block.succs.begin(), block.succs.end()},
+                                  {block.preds.begin(), block.preds.end()}});
+    }
+    auto& blocks = builder.blocks;
+
+    // Remove the empty blocks by connecting their predecessors directly to
+    // their successors. This is possible when an empty block has a single
+    // successor or a single predecessor.
+    struct Removal
+    {
+        int block;
+        int target;
+        bool atStart;
+    };
+    std::vector<Removal> removals;
+    std::vector<bool> removed(blockCount, false);
+    for (int id = 1; id < endBlock; ++id)
+    {
+        Builder::Block& block = blocks[id];
+        if (!block.ops.empty() || std::ranges::find(block.succs, id) != block.succs.end())
+            continue;
+        // The state of the block is the state at the end of its predecessor
+        // or at the start of its successor, the former is exact.
+        if (block.preds.size() == 1)
+        {
+            const int pred = block.preds.front();
+            replaceId(blocks[pred].succs, id, block.succs);
+            for (int succ : block.succs)
+                replaceId(blocks[succ].preds, id, std::span(&pred, 1));
+            removals.push_back({id, pred, false});
+        }
+        else if (block.succs.size() == 1)
+        {
+            const int succ = block.succs.front();
+            for (int pred : block.preds)
+                replaceId(blocks[pred].succs, id, std::span(&succ, 1));
+            replaceId(blocks[succ].preds, id, block.preds);
+            removals.push_back({id, succ, true});
+        }
+        else
+            continue;
+        removed[id] = true;
+        block = {};
+    }
+
+    // Merge the chains where a block is the only successor of its only predecessor.
+    std::vector<int> mergedInto(blockCount, -1);
+    for (int id = 0; id < blockCount; ++id)
+    {
+        const auto& succs = blocks[id].succs;
+        if (removed[id] || succs.size() != 1 || succs.front() == id || succs.front() == 0)
+            continue;
+        if (blocks[succs.front()].preds.size() == 1)
+            mergedInto[succs.front()] = id;
+    }
+
+    // The heads of the chains become the blocks of the simplified CFG, the end
+    // block is kept last.
+    std::vector<int> headOf(blockCount, -1);
+    std::vector<int> heads;
+    int endHead = endBlock;
+    while (mergedInto[endHead] >= 0)
+        endHead = mergedInto[endHead];
+    for (int id = 0; id < blockCount; ++id)
+    {
+        if (!removed[id] && mergedInto[id] < 0 && id != endHead)
+            heads.push_back(id);
+    }
+    heads.push_back(endHead);
+    std::vector<int> newIds(blockCount, -1);
+    for (std::size_t i = 0; i < heads.size(); ++i)
+        newIds[heads[i]] = i;
+
+    // Where the blocks start and end in the simplified CFG.
+    std::vector<BlockLocation> starts(blockCount);
+    std::vector<BlockLocation> ends(blockCount);
+    Builder simplified;
+    simplified.blocks.resize(heads.size());
+    for (std::size_t i = 0; i < heads.size(); ++i)
+    {
+        Builder::Block& merged = simplified.blocks[i];
+        int current = heads[i];
+        while (true)
+        {
+            headOf[current] = heads[i];
+            starts[current] = {static_cast<int>(i), static_cast<int>(merged.ops.size())};
+            merged.ops.insert(merged.ops.end(), blocks[current].ops.begin(), blocks[current].ops.end());
+            ends[current] = {static_cast<int>(i), static_cast<int>(merged.ops.size())};
+            const auto& succs = blocks[current].succs;
+            if (succs.size() != 1 || mergedInto[succs.front()] != current)
+                break;
+            current = succs.front();
+        }
+        for (int succ : blocks[current].succs)
+            merged.succs.push_back(newIds[succ]);
+    }
+    for (std::size_t i = 0; i < heads.size(); ++i)
+    {
+        for (int pred : blocks[heads[i]].preds)
+            simplified.blocks[i].preds.push_back(newIds[headOf[pred]]);
+    }
+    // A removed block can be the target of a block removed earlier.
+    for (const Removal& removal : std::views::reverse(removals))
+    {
+        const BlockLocation location = removal.atStart ? starts[removal.target] : ends[removal.target];
+        starts[removal.block] = location;
+        ends[removal.block] = location;
+    }
+    CFG result = simplified.freeze();
+    result.flatNodes = flatNodes;
+    return {std::move(result), std::move(ends)};
+}
+
+const DominatorTree& CFG::dominators() const
+{
+    return dominatorTree.get([this] { return DominatorTree(*this); });
+}
+
+const DominatorTree& CFG::postDominators() const
+{
+    return postDominatorTree.get([this] { return ReverseCFG(*this).dominators().mirrored(); });
+}
+
+const LoopForest& CFG::loops() const
+{
+    return loopForest.get([this] { return LoopForest(*this); });
+}
+
+const DominatorTree& ReverseCFG::dominators() const
+{
+    return dominatorTree.get([this] { return DominatorTree(*this); });
+}
+
+const DominatorTree& ReverseCFG::postDominators() const
+{
+    return postDominatorTree.get([this] { return cfg.dominators().mirrored(); });
+}
+
+const LoopForest& ReverseCFG::loops() const
+{
+    return loopForest.get([this] { return LoopForest(*this); });
+}
+
+DominatorTree DominatorTree::mirrored() const
+{
+    const int last = idoms.size() - 1;
+    DominatorTree result;
+    result.root = last - root;
+    result.idoms.resize(idoms.size());
+    for (int block = 0; block <= last; ++block)
+        result.idoms[last - block] = idoms[block] < 0 ? -1 : last - idoms[block];
+    result.buildTree();
+    return result;
+}
+
+void DominatorTree::buildTree()
+{
+    const std::size_t blockCount = idoms.size();
+    childStarts.assign(blockCount + 1, 0);
+    for (int idom : idoms)
+    {
+        if (idom >= 0)
+            ++childStarts[idom + 1];
+    }
+    for (std::size_t block = 0; block < blockCount; ++block)
+        childStarts[block + 1] += childStarts[block];
+    childIds.resize(childStarts.back());
+    std::vector<int> filled(childStarts.begin(), childStarts.end() - 1);
+    for (std::size_t block = 0; block < blockCount; ++block)
+    {
+        if (idoms[block] >= 0)
+            childIds[filled[idoms[block]]++] = block;
+    }
+
+    enter.assign(blockCount, -1);
+    exit.assign(blockCount, -1);
+    int counter = 0;
+    // The blocks on the path from the root and the next child to visit.
+    std::vector<std::pair<int, std::size_t>> stack{{root, 0}};
+    enter[root] = counter++;
+    while (!stack.empty())
+    {
+        auto& [block, next] = stack.back();
+        if (next < children(block).size())
+        {
+            int child = children(block)[next++];
+            enter[child] = counter++;
+            stack.emplace_back(child, 0);
+            continue;
+        }
+        exit[block] = counter++;
+        stack.pop_back();
+    }
 }
@@ -0,0 +1,73 @@
+#include "include/cfg_export.h"
+
+#include <cerrno>
+#include <ostream>
+
+#include <unistd.h>
+
+void BufferedWriter::flush() noexcept
+{
+    if (buffer.size() == 0)
+        return;
+    if (out)
+    {
+        out->write(buffer.data(), buffer.size());
+        failed |= !*out;
+    }
+    else
+    {
+        const char* data = buffer.data();
+        std::size_t remaining = buffer.size();
+        while (remaining > 0 && !failed)
+        {
+            ssize_t written = ::write(fd, data, remaining);
+            if (written < 0 && errno == EINTR)
+                continue;
+            if (written <= 0)
+            {
+                failed = true;
+                break;
+            }
+            data += written;
+            remaining -= written;
+        }
+    }
+    buffer.clear();
+}
+
+std::optional<CfgFormat> parseCfgFormat(std::string_view name) noexcept
+{
+    if (name == "dot")
+        return CfgFormat::Dot;
+    if (name == "json")
+        return CfgFormat::Json;
+    if (name == "edges")
+        return CfgFormat::EdgeList;
+    return {};
+}
+
+namespace
+{
+struct OperationWriter
+{
+    void operator()(InitOp i) const
+    {
+        out.print("init({}, {}, {}, {})", i.topX, i.topY, i.width, i.height);
+    }
+    void operator()(TranslationOp t) const
+    {
+        out.print("translation({}, {})", t.x, t.y);
+    }
+    void operator()(RotationOp r) const
+    {
+        out.print("rotation({}, {}, {})", r.x, r.y, r.deg);
+    }
+
+    BufferedWriter& out;
+};
+} // anonymous namespace
+
+void writeOperation(BufferedWriter& out, Operation op)
+{
+    op.visit(OperationWriter{out});
+}
@@ -9,24 +9,24 @@ namespace
 {
 struct TransferOperation
 {
-    Vec2Interval operator()(const Init* init) const
+    Vec2Interval operator()(InitOp init) const
     {
-        int x = *init->topX.value;
-        int y = *init->topY.value;
-        int w = *init->width.value;
-        int h = *init->height.value;
+        int x = init.topX;
+        int y = init.topY;
+        int w = init.width;
+        int h = init.height;
         return Vec2Interval{ IntervalDomain{x, x + w}, IntervalDomain{y, y + h} };
     }
 
-    Vec2Interval operator()(const Translation* t) const
+    Vec2Interval operator()(TranslationOp t) const
     {
-        return Vec2Interval{preState.x + IntervalDomain{*t->x.value},
-                            preState.y + IntervalDomain{*t->y.value}};
+        return Vec2Interval{preState.x + IntervalDomain{t.x},
+                            preState.y + IntervalDomain{t.y}};
     }
 
-    Vec2Interval operator()(const Rotation* r) const
+    Vec2Interval operator()(RotationOp r) const
     {
-        int degree = *r->deg.value;
+        int degree = r.deg;
         // Rotation by the multiple of 360 degrees will not change the state.
         if (degree % 360 == 0)
             return preState;
@@ -36,7 +36,7 @@ struct TransferOperation
         // First translate the state so the rotation's center is at the origo.
         // Then do the rotation as if inf and -inf were just regular numbers.
         // Then undo the translation.
-        Vec2 origin{*r->x.value, *r->y.value};
+        Vec2 origin{r.x, r.y};
         Vec2Interval toRotate{preState.x + IntervalDomain{-origin.x},
                               preState.y + IntervalDomain{-origin.y}};
         if (degree % 360 == 270)
@@ -104,7 +104,7 @@ struct TransferOperation
 
 Vec2Interval IntervalTransfer::operator()(Operation op, Vec2Interval preState) const
 {
-    return std::visit(TransferOperation{preState}, op);
+    return op.visit(TransferOperation{preState});
 }
 
 std::vector<Vec2Interval> getPrimitiveIntervalAnalysis(const CFG& cfg)
@@ -117,6 +117,21 @@ std::vector<Vec2Interval> getIntervalAnalysis(const CFG& cfg)
     return solveMonotoneFrameworkWithWidening<Vec2Interval, IntervalTransfer>(cfg);
 }
 
+std::vector<Vec2Interval> getNarrowedIntervalAnalysis(const CFG& cfg)
+{
+    return solveMonotoneFrameworkWithNarrowing<Vec2Interval, IntervalTransfer>(cfg);
+}
+
+std::vector<Vec2Interval> getWtoIntervalAnalysis(const CFG& cfg)
+{
+    return solveMonotoneFrameworkWithWto<Vec2Interval, IntervalTransfer>(cfg);
+}
+
+std::vector<Vec2Interval> getSccIntervalAnalysis(const CFG& cfg)
+{
+    return solveMonotoneFrameworkWithScc<Vec2Interval, IntervalTransfer>(cfg);
+}
+
 Annotations intervalAnalysisToOperationAnnotations(const CFG& cfg,
                                                    const std::vector<Vec2Interval>& results)
 {
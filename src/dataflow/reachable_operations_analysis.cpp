@@ -6,28 +6,28 @@ namespace
 {
 struct TransferOperation
 {
-    StringSetDomain operator()(const Init*) const
+    StringSetDomain operator()(InitOp) const
     {
-        return preState.insert("Init");
+        return std::move(preState).insert("Init");
     }
 
-    StringSetDomain operator()(const Translation*) const
+    StringSetDomain operator()(TranslationOp) const
     {
-        return preState.insert("Translation");
+        return std::move(preState).insert("Translation");
     }
 
-    StringSetDomain operator()(const Rotation*) const
+    StringSetDomain operator()(RotationOp) const
     {
-        return preState.insert("Rotation");
+        return std::move(preState).insert("Rotation");
     }
 
-    const StringSetDomain& preState;
+    StringSetDomain& preState;
 };
 } // anonymous namespace
 
-StringSetDomain ReachableOperationsTransfer::operator()(Operation op, const StringSetDomain& preState) const
+StringSetDomain ReachableOperationsTransfer::operator()(Operation op, StringSetDomain preState) const
 {
-    return std::visit(TransferOperation{preState}, op);
+    return op.visit(TransferOperation{preState});
 }
 
 std::vector<StringSetDomain> getPastOperationsAnalysis(const CFG& cfg)
@@ -40,6 +40,11 @@ std::vector<StringSetDomain> getFutureOperationsAnalysis(const ReverseCFG& cfg)
     return solveMonotoneFramework<StringSetDomain, ReachableOperationsTransfer>(cfg);
 }
 
+std::vector<StringSetDomain> getFutureOperationsAnalysis(const MaterializedReverseCFG& cfg)
+{
+    return solveMonotoneFramework<StringSetDomain, ReachableOperationsTransfer>(cfg);
+}
+
 Annotations pastOperationsAnalysisToOperationAnnotations(const CFG& cfg,
                                                          const std::vector<StringSetDomain>& results)
 {
@@ -51,3 +56,9 @@ Annotations futureOperationsAnalysisToOperationAnnotations(const ReverseCFG& cfg
 {
     return allAnnotationsFromAnalysisResults<StringSetDomain, ReachableOperationsTransfer>(cfg, results);
 }
+
+Annotations futureOperationsAnalysisToOperationAnnotations(const MaterializedReverseCFG& cfg,
+                                                           const std::vector<StringSetDomain>& results)
+{
+    return allAnnotationsFromAnalysisResults<StringSetDomain, ReachableOperationsTransfer>(cfg, results);
+}
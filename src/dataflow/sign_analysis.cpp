@@ -9,10 +9,10 @@ using enum SignValue;
 struct TransferOperation
 {
     // TODO: topX and topY are misleading, we should rename them.
-    Vec2Sign operator()(const Init* init) const
+    Vec2Sign operator()(InitOp init) const
     {
         SignDomain xSign{
-            [topX = *init->topX.value, width = *init->width.value]() {
+            [topX = init.topX, width = init.width]() {
                 if (topX > 0)
                     return Positive;
                 if (topX + width < 0)
@@ -25,7 +25,7 @@ struct TransferOperation
         };
 
         SignDomain ySign{
-            [topY = *init->topY.value, height = *init->height.value]() {
+            [topY = init.topY, height = init.height]() {
                 if (topY > 0)
                     return Positive;
                 if (topY + height < 0)
@@ -40,19 +40,19 @@ struct TransferOperation
         return Vec2Sign{ xSign, ySign };
     }
 
-    Vec2Sign operator()(const Translation* t) const
+    Vec2Sign operator()(TranslationOp t) const
     {
-        return Vec2Sign{preState.x + SignDomain{*t->x.value},
-                        preState.y + SignDomain{*t->y.value}};
+        return Vec2Sign{preState.x + SignDomain{t.x},
+                        preState.y + SignDomain{t.y}};
     }
 
-    Vec2Sign operator()(const Rotation* r) const
+    Vec2Sign operator()(RotationOp r) const
     {
-        int deg = *r->deg.value;
+        int deg = r.deg;
         if (deg % 360 == 0)
             return preState;
 
-        if (*r->x.value == 0 && *r->y.value == 0)
+        if (r.x == 0 && r.y == 0)
         {
             if (deg % 360 == 270)
                 return Vec2Sign{preState.y, -preState.x};
@@ -71,7 +71,7 @@ struct TransferOperation
 
 Vec2Sign SignTransfer::operator()(Operation op, Vec2Sign preState) const
 {
-    return std::visit(TransferOperation{preState}, op);
+    return op.visit(TransferOperation{preState});
 }
 
 std::vector<Vec2Sign> getSignAnalysis(const CFG& cfg)
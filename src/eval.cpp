@@ -6,7 +6,6 @@
 #include <algorithm>
 #include <random>
 #include <numbers>
-#include <set>
 #include <unordered_map>
 
 #include <fmt/format.h>
@@ -15,27 +14,26 @@ namespace
 {
 double toRad(double deg) noexcept { return deg / 180 * std::numbers::pi_v<double>; }
 
+// The position after an operation, the previous position is not used by
+// the Init operations.
 struct StepEval {
-    const Step* in;
+    Vec2 in;
     std::mt19937& gen;
-    Step operator()(const Init* i) const noexcept
+    Vec2 operator()(InitOp i) const noexcept
     {
-        std::uniform_int_distribution<int> genX(*i->topX.value, *i->topX.value + *i->width.value);
-        std::uniform_int_distribution<int> genY(*i->topY.value, *i->topY.value + *i->height.value);
-        return Step{ Vec2{ genX(gen), genY(gen) }, i};
+        std::uniform_int_distribution<int> genX(i.topX, i.topX + i.width);
+        std::uniform_int_distribution<int> genY(i.topY, i.topY + i.height);
+        return Vec2{ genX(gen), genY(gen) };
     }
 
-    Step operator()(const Translation* t) const noexcept
+    Vec2 operator()(TranslationOp t) const noexcept
     {
-        return Step{ in->pos + Vec2{ *t->x.value, *t->y.value }, t };
+        return in + Vec2{ t.x, t.y };
     }
 
-    Step operator()(const Rotation* r) const noexcept
+    Vec2 operator()(RotationOp r) const noexcept
     {
-        Vec2 origin{*r->x.value, *r->y.value};
-        Vec2 toRotate{ in->pos.x, in->pos.y };
-        Vec2 rotated = rotate(toRotate, origin, *r->deg.value);
-        return Step{ rotated, r };
+        return rotate(in, Vec2{r.x, r.y}, r.deg);
     }
 };
 } // anonymous namespace
@@ -54,31 +52,13 @@ Vec2 rotate(Vec2 toRotate, Vec2 origin, int degree)
 
 namespace
 {
-std::set<std::pair<int, int>> detectBackEdges(const CFG& cfg, int current, const std::set<int>& visited)
+int getNextBlock(std::mt19937& gen, const CFG& cfg, int current, int loopiness)
 {
-    // Only do back-edge detection when we first encounter a node.
-    if (visited.contains(current))
-        return {};
-
-    std::set<std::pair<int, int>> ret;
-    for(auto succ : cfg.blocks()[current].successors())
-    {
-        // In every walk, in order to take the back edge of a loop,
-        // we first need to enter the loop. Thus, if the target of the
-        // edge is already visited, we see a back edge.
-        if (visited.contains(succ) || succ == current)
-            ret.insert(std::make_pair(current, succ));
-    }
-    return ret;
-}
-
-int getNextBlock(std::mt19937& gen, const CFG& cfg, int current,
-                      const std::set<std::pair<int, int>>& backEdges, int loopiness)
-{
-    std::vector<int> successors = cfg.blocks()[current].successors();
+    auto blockSuccessors = cfg.blocks()[current].successors();
+    std::vector<int> successors(blockSuccessors.begin(), blockSuccessors.end());
     auto it = std::partition(successors.begin(), successors.end(),
-        [&backEdges, current](int succ) {
-            return !backEdges.contains(std::make_pair(current, succ));
+        [&dfs = cfg.dfsTree(), current](int succ) {
+            return !dfs.isBackEdge(current, succ);
         });
 
     int regularEdgeNum = it - successors.begin();
@@ -100,46 +80,36 @@ int getNextBlock(std::mt19937& gen, const CFG& cfg, int current,
 Walk createRandomWalk(const CFG& cfg, int loopiness)
 {
     Walk w;
-    if (!std::holds_alternative<const Init*>(cfg.blocks().at(0).operations().at(0)))
+    auto startOperations = cfg.blocks().front().operations();
+    if (startOperations.empty() || startOperations.front().getKind() != Operation::Kind::Init)
         return w; // TODO: add error message.
 
     std::random_device rd;
     std::mt19937 gen(rd());
 
-    // Discover what edges are back edges as we go to correctly 
-    // account for loopiness when choosing the next block.
-    std::set<int> visited;
-    std::set<std::pair<int, int>> backEdges;
-
     int current = 0;
     do 
     {
         for (Operation o : cfg.blocks()[current].operations())
         {
-            Step step = [&] {
-                if (w.empty())
-                    return std::visit(StepEval{nullptr, gen}, o);
-                return std::visit(StepEval{&w.back(), gen}, o);
-            }();
-            w.push_back(step);
+            Vec2 previous = w.empty() ? Vec2{} : w.back().pos;
+            w.push_back(Step{o.visit(StepEval{previous, gen}), o});
         }
         if (cfg.blocks()[current].successors().empty())
             break;
-        backEdges.merge(detectBackEdges(cfg, current, visited));
-        visited.insert(current);
-        current = getNextBlock(gen, cfg, current, backEdges, loopiness);
+        current = getNextBlock(gen, cfg, current, loopiness);
     } while (true);
 
     return w;
 }
 
-Annotations annotateWithWalks(const std::vector<Walk>& walks)
+Annotations annotateWithWalks(const CFG& cfg, const std::vector<Walk>& walks)
 {
-    std::unordered_map<Operation, std::vector<Vec2>> collectedSteps;
+    std::unordered_map<Node, std::vector<Vec2>> collectedSteps;
 
     for (const auto& walk : walks)
         for (auto step : walk)
-            collectedSteps[step.op].push_back(step.pos);
+            collectedSteps[cfg.getNode(step.op)].push_back(step.pos);
 
     auto printSet = [](const std::vector<Vec2>& positions) {
         std::string result{"{"};
@@ -157,8 +127,8 @@ Annotations annotateWithWalks(const std::vector<Walk>& walks)
     };
 
     Annotations anns;
-    for (const auto& [op, positions] : collectedSteps)
-        anns.postAnnotations[toNode(op)].push_back(printSet(positions));
+    for (const auto& [node, positions] : collectedSteps)
+        anns.postAnnotations[node].push_back(printSet(positions));
 
     return anns;
 }
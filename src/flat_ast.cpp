@@ -0,0 +1,194 @@
+#include "include/flat_ast.h"
+
+#include <array>
+
+namespace
+{
+template<typename T>
+constexpr NodeKind kindOf() noexcept
+{
+    if constexpr (std::is_same_v<T, Init>) return NodeKind::Init;
+    if constexpr (std::is_same_v<T, Translation>) return NodeKind::Translation;
+    if constexpr (std::is_same_v<T, Rotation>) return NodeKind::Rotation;
+    if constexpr (std::is_same_v<T, Sequence>) return NodeKind::Sequence;
+    if constexpr (std::is_same_v<T, Branch>) return NodeKind::Branch;
+    if constexpr (std::is_same_v<T, Loop>) return NodeKind::Loop;
+}
+
+struct NodeCounts
+{
+    std::array<std::size_t, 6> perKind{};
+    std::size_t children = 0;
+};
+
+NodeCounts countNodes(const Sequence* root)
+{
+    NodeCounts counts;
+    std::vector<Node> stack{root};
+    while (!stack.empty())
+    {
+        Node node = stack.back();
+        stack.pop_back();
+        std::visit([&counts, &stack]<typename T>(const T* n) {
+            ++counts.perKind[static_cast<int>(kindOf<T>())];
+            if constexpr (std::is_same_v<T, Sequence>)
+            {
+                counts.children += n->nodes.size();
+                stack.insert(stack.end(), n->nodes.begin(), n->nodes.end());
+            }
+            if constexpr (std::is_same_v<T, Branch>)
+            {
+                stack.push_back(n->lhs);
+                stack.push_back(n->rhs);
+            }
+            if constexpr (std::is_same_v<T, Loop>)
+                stack.push_back(n->body);
+        }, node);
+    }
+    return counts;
+}
+} // anonymous namespace
+
+// Copies the nodes in preorder into the arrays that are already allocated
+// with the exact sizes. Every pending node knows where its id has to be
+// stored.
+struct FlatAST::Builder
+{
+    struct Pending
+    {
+        Node node;
+        NodeId* childSlot = nullptr;
+        std::uint32_t* sequenceSlot = nullptr;
+    };
+
+    void build(const Sequence* root)
+    {
+        // The root is the first sequence, it is not referenced from anywhere.
+        stack.push_back({root});
+        while (!stack.empty())
+        {
+            Pending pending = stack.back();
+            stack.pop_back();
+            NodeId id = std::visit([this](const auto* n) { return add(n); }, pending.node);
+            if (pending.childSlot)
+                *pending.childSlot = id;
+            if (pending.sequenceSlot)
+                *pending.sequenceSlot = id.index();
+        }
+    }
+
+    NodeId add(const Init* i) noexcept
+    {
+        inits[nextInit] = *i;
+        return NodeId(NodeKind::Init, nextInit++);
+    }
+    NodeId add(const Translation* t) noexcept
+    {
+        translations[nextTranslation] = *t;
+        return NodeId(NodeKind::Translation, nextTranslation++);
+    }
+    NodeId add(const Rotation* r) noexcept
+    {
+        rotations[nextRotation] = *r;
+        return NodeId(NodeKind::Rotation, nextRotation++);
+    }
+    NodeId add(const Sequence* s)
+    {
+        const auto count = static_cast<std::uint32_t>(s->nodes.size());
+        sequences[nextSequence] = FlatSequence{nextChild, count};
+        NodeId* children = sequenceChildren.data() + nextChild;
+        nextChild += count;
+        // The children are pushed in reverse so they are copied in order.
+        for (std::uint32_t i = count; i-- > 0;)
+            stack.push_back({s->nodes[i], &children[i]});
+        return NodeId(NodeKind::Sequence, nextSequence++);
+    }
+    NodeId add(const Branch* b)
+    {
+        FlatBranch& result = branches[nextBranch];
+        result.kw = b->kw;
+        stack.push_back({b->rhs, nullptr, &result.rhs});
+        stack.push_back({b->lhs, nullptr, &result.lhs});
+        return NodeId(NodeKind::Branch, nextBranch++);
+    }
+    NodeId add(const Loop* l)
+    {
+        FlatLoop& result = loops[nextLoop];
+        result.kw = l->kw;
+        stack.push_back({l->body, nullptr, &result.body});
+        return NodeId(NodeKind::Loop, nextLoop++);
+    }
+
+    std::span<Init> inits;
+    std::span<Translation> translations;
+    std::span<Rotation> rotations;
+    std::span<FlatSequence> sequences;
+    std::span<FlatBranch> branches;
+    std::span<FlatLoop> loops;
+    std::span<NodeId> sequenceChildren;
+    std::vector<Pending> stack{};
+    std::uint32_t nextInit = 0;
+    std::uint32_t nextTranslation = 0;
+    std::uint32_t nextRotation = 0;
+    std::uint32_t nextSequence = 0;
+    std::uint32_t nextBranch = 0;
+    std::uint32_t nextLoop = 0;
+    std::uint32_t nextChild = 0;
+};
+
+FlatAST FlatAST::flatten(ASTContext&& context)
+{
+    NodeCounts counts = countNodes(context.getRoot());
+
+    FlatAST ast;
+    ast.inits.resize(counts.perKind[static_cast<int>(NodeKind::Init)]);
+    ast.translations.resize(counts.perKind[static_cast<int>(NodeKind::Translation)]);
+    ast.rotations.resize(counts.perKind[static_cast<int>(NodeKind::Rotation)]);
+    ast.sequences.resize(counts.perKind[static_cast<int>(NodeKind::Sequence)]);
+    ast.branches.resize(counts.perKind[static_cast<int>(NodeKind::Branch)]);
+    ast.loops.resize(counts.perKind[static_cast<int>(NodeKind::Loop)]);
+    ast.sequenceChildren.resize(counts.children);
+
+    Builder builder{ast.inits.mutableSpan(), ast.translations.mutableSpan(), ast.rotations.mutableSpan(),
+                    ast.sequences.mutableSpan(), ast.branches.mutableSpan(), ast.loops.mutableSpan(),
+                    ast.sequenceChildren.mutableSpan()};
+    builder.build(context.getRoot());
+    ast.tokens = context.takeTokens();
+    return ast;
+}
+
+Node FlatAST::getNode(NodeId id) const noexcept
+{
+    switch (id.kind())
+    {
+    case NodeKind::Init: return &inits[id.index()];
+    case NodeKind::Translation: return &translations[id.index()];
+    case NodeKind::Rotation: return &rotations[id.index()];
+    default: break;
+    }
+    assert(false && "Only the operations have a Node");
+    return {};
+}
+
+NodeId FlatAST::getId(Node node) const noexcept
+{
+    return std::visit([this]<typename T>(const T* n) {
+        if constexpr (std::is_same_v<T, Init>)
+            return NodeId(NodeKind::Init, static_cast<std::uint32_t>(n - inits.data()));
+        else if constexpr (std::is_same_v<T, Translation>)
+            return NodeId(NodeKind::Translation, static_cast<std::uint32_t>(n - translations.data()));
+        else if constexpr (std::is_same_v<T, Rotation>)
+            return NodeId(NodeKind::Rotation, static_cast<std::uint32_t>(n - rotations.data()));
+        else
+        {
+            assert(false && "Only the operations have a Node");
+            return NodeId{};
+        }
+    }, node);
+}
+
+std::size_t FlatAST::getNodeCount() const noexcept
+{
+    return inits.size() + translations.size() + rotations.size() +
+           sequences.size() + branches.size() + loops.size();
+}
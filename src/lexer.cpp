@@ -2,8 +2,10 @@
 
 #include <fmt/format.h>
 
-#include <cstdlib>
-#include <unordered_map>
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <charconv>
 
 using enum TokenType;
 
@@ -19,79 +21,147 @@ std::string print(Token t) noexcept
     }
 }
 
-std::vector<Token> Lexer::lexAll() noexcept
+SourceLocation LocationTable::locate(std::uint32_t offset) const noexcept
 {
-    std::vector<Token> result;
+    // The first line starts at offset 0, so there is always a line start
+    // that is not greater than the offset.
+    auto it = std::upper_bound(lineStarts.begin(), lineStarts.end(), offset);
+    auto lineIdx = static_cast<unsigned>(it - lineStarts.begin());
+    return {file, lineIdx, offset - *std::prev(it) + 1};
+}
+
+TokenId TokenBuffer::push(const Token& t)
+{
+    auto id = static_cast<TokenId>(types.size());
+    types.push_back(t.type);
+    offsets.push_back(t.offset);
+    if (t.type == NUMBER)
+    {
+        numbers.push_back(*t.value);
+        numberIds.push_back(id);
+    }
+    return id;
+}
+
+int TokenBuffer::value(TokenId id) const noexcept
+{
+    assert(types[id] == NUMBER);
+    auto it = std::lower_bound(numberIds.begin(), numberIds.end(), id);
+    return numbers[it - numberIds.begin()];
+}
+
+Token TokenBuffer::operator[](TokenId id) const noexcept
+{
+    std::uint32_t offset = offsets[id];
+    unsigned line = locations.locate(offset).line;
+    if (types[id] == NUMBER)
+        return Token(NUMBER, line, offset, value(id));
+    return Token(types[id], line, offset);
+}
+
+std::size_t TokenBuffer::memoryUsage() const noexcept
+{
+    return types.capacity() * sizeof(TokenType) +
+           offsets.capacity() * sizeof(std::uint32_t) +
+           numbers.capacity() * sizeof(int) +
+           numberIds.capacity() * sizeof(TokenId);
+}
+
+std::optional<Token> Lexer::next() noexcept
+{
+    if (hasError)
+        return std::nullopt;
 
     while (!isAtEnd())
     {
         if (auto maybeToken = lex(); maybeToken.has_value())
-            result.push_back(*maybeToken);
-        else if (hasError)
-            return {};
+            return maybeToken;
+        if (hasError)
+            return std::nullopt;
     }
 
-    result.emplace_back(END_OF_FILE, line);
-    return result;
+    start = current;
+    return makeToken(END_OF_FILE);
+}
+
+TokenBuffer Lexer::lexAll() noexcept
+{
+    TokenBuffer result;
+
+    while (true)
+    {
+        auto maybeToken = next();
+        if (!maybeToken)
+            return TokenBuffer{};
+
+        result.push(*maybeToken);
+        if (maybeToken->type == END_OF_FILE)
+        {
+            result.setLocations(locations);
+            return result;
+        }
+    }
 }
 
 std::optional<Token> Lexer::lex() noexcept
 {
     while (true)
     {
+        // Most tokens are separated by at most a single space, do not pay
+        // for the bulk scan in that case.
+        if (!isAtEnd() && isWhitespace(source[current]))
+        {
+            if (source[current] == ' ')
+                ++current;
+            skipTo(scan->skipWhitespace(cursor(), sourceEnd()));
+        }
+        if (isAtEnd())
+            return std::nullopt;
+
         start = current;
         char c = advance();
         switch (c)
         {
         //  Unambiguous single characters tokens.
         case '(':
-            return Token(LEFT_PAREN, line);
+            return makeToken(LEFT_PAREN);
         case ')':
-            return Token(RIGHT_PAREN, line);
+            return makeToken(RIGHT_PAREN);
         case '{':
-            return Token(LEFT_BRACE, line);
+            return makeToken(LEFT_BRACE);
         case '}':
-            return Token(RIGHT_BRACE, line);
+            return makeToken(RIGHT_BRACE);
 
-        case ',': return Token(COMMA, line);
-        case ';': return Token(SEMICOLON, line);
-
-        // Whitespace.
-        case '\n':
-            line++;
-            [[fallthrough]];
-        case ' ':
-        case '\r':
-        case '\t':
-            break;
+        case ',': return makeToken(COMMA);
+        case ';': return makeToken(SEMICOLON);
 
         // Comments
         case '/':
             if (match('/'))
             {
-                // Skip to end of line for comment.
-                while (advance() != '\n' && !isAtEnd())
-                    ;
+                // Skip to end of line for comment, the new line
+                // itself is skipped as whitespace.
+                skipTo(scan->find(cursor(), sourceEnd(), '\n'));
                 break;
             }
             if (match('*'))
             {
                 // Skip to end of comment. TODO: make this nestable?
-                do
+                while (true)
                 {
-                    while (advance() != '*' && !isAtEnd())
-                        ;
-
-                    if (isAtEnd())
+                    const char* star = scan->find(cursor(), sourceEnd(), '*');
+                    if (star == sourceEnd())
                     {
+                        skipTo(star);
                         diag.error(line, fmt::format("Multiline comment not closed."));
                         hasError = true;
                         return std::nullopt;
                     }
 
-                    if (advance() == '/')
+                    skipTo(star + 1);
+                    if (match('/'))
                         break;
-                } while (true);
+                }
                 break;
             }
             diag.error(line, fmt::format("Unexpected token: '{}'.", source.substr(start, current - start)));
@@ -100,11 +170,13 @@ std::optional<Token> Lexer::lex() noexcept
 
         // Negative numbers.
         case '-':
-            if (auto num = lexNumber())
-                return num;
-            diag.error(line, fmt::format("Expected number after '-'."));
-            hasError = true;
-            return std::nullopt;
+            if (!isdigit(peek()))
+            {
+                diag.error(line, fmt::format("Expected number after '-'."));
+                hasError = true;
+                return std::nullopt;
+            }
+            return lexNumber();
 
         default:
             if (isdigit(c))
@@ -117,34 +189,89 @@ std::optional<Token> Lexer::lex() noexcept
             hasError = true;
             return std::nullopt;
         }
-
-        if (isAtEnd())
-            return std::nullopt;
     }
 }
 
 std::optional<Token> Lexer::lexNumber() noexcept
 {
-    while (isdigit(peek()))
-        advance();
+    skipTo(scan->skipDigits(cursor(), sourceEnd()));
 
+    // The source is not necessarily null terminated, e.g., when it is
+    // memory-mapped, so strtol is not an option.
     auto num = source.substr(start, current - start);
-    char *end;
-    int value = strtol(num.c_str(), &end, 10);
-    if (end == num.c_str())
-        return {};
+    int value = 0;
+    auto result = std::from_chars(num.data(), num.data() + num.size(), value);
+    if (result.ec == std::errc::result_out_of_range)
+    {
+        diag.error(line, fmt::format("Number literal out of range: '{}'.", num));
+        hasError = true;
+        return std::nullopt;
+    }
+    assert(result.ec == std::errc{} && result.ptr == num.data() + num.size());
 
-    return Token(NUMBER, line, value);
+    return makeToken(NUMBER, value);
 }
 
 namespace {
-const std::unordered_map<std::string_view, TokenType> keywords = {
-    {tokenTypeToSourceName(INIT),    INIT},
-    {tokenTypeToSourceName(OR),     OR},
-    {tokenTypeToSourceName(TRANSLATION),  TRANSLATION},
-    {tokenTypeToSourceName(ROTATION),  ROTATION},
-    {tokenTypeToSourceName(ITER),    ITER},
-};
+// Perfect hash table for the keywords, generated at compile time from the
+// keyword range of TokenType. The hash only looks at the length and the
+// first and last characters, the seed is searched for until there are no
+// collisions.
+constexpr unsigned firstKeyword = static_cast<unsigned>(NUMBER) + 1;
+constexpr unsigned lastKeyword = static_cast<unsigned>(END_OF_FILE) - 1;
+constexpr unsigned keywordCount = lastKeyword - firstKeyword + 1;
+constexpr unsigned keywordTableSize = std::bit_ceil(2 * keywordCount);
+
+constexpr unsigned keywordHash(std::string_view text, unsigned seed) noexcept
+{
+    auto first = static_cast<unsigned char>(text.front());
+    auto last = static_cast<unsigned char>(text.back());
+    return (first * seed + last + static_cast<unsigned>(text.size())) & (keywordTableSize - 1);
+}
+
+constexpr bool isCollisionFree(unsigned seed) noexcept
+{
+    std::array<bool, keywordTableSize> used{};
+    for (unsigned kw = firstKeyword; kw <= lastKeyword; ++kw)
+    {
+        unsigned slot = keywordHash(tokenTypeToSourceName(static_cast<TokenType>(kw)), seed);
+        if (used[slot])
+            return false;
+        used[slot] = true;
+    }
+    return true;
+}
+
+constexpr unsigned keywordSeed = [] {
+    for (unsigned seed = 1; seed < 1024; ++seed)
+        if (isCollisionFree(seed))
+            return seed;
+    return 0U;
+}();
+static_assert(keywordSeed != 0, "No collision-free keyword hash, consider growing the table.");
+
+// END_OF_FILE marks the empty slots.
+constexpr auto keywordTable = [] {
+    std::array<TokenType, keywordTableSize> table{};
+    table.fill(END_OF_FILE);
+    for (unsigned kw = firstKeyword; kw <= lastKeyword; ++kw)
+        table[keywordHash(tokenTypeToSourceName(static_cast<TokenType>(kw)), keywordSeed)] = static_cast<TokenType>(kw);
+    return table;
+}();
+static_assert(std::ranges::count(keywordTable, END_OF_FILE) == keywordTableSize - keywordCount);
+
+constexpr std::optional<TokenType> lookupKeyword(std::string_view text) noexcept
+{
+    if (text.empty())
+        return std::nullopt;
+    TokenType candidate = keywordTable[keywordHash(text, keywordSeed)];
+    if (candidate != END_OF_FILE && tokenTypeToSourceName(candidate) == text)
+        return candidate;
+    return std::nullopt;
+}
+
+static_assert(lookupKeyword("iter") == ITER);
+static_assert(!lookupKeyword("iterr"));
 } // anonymous namespace
 
 std::optional<Token> Lexer::lexKeyword() noexcept
@@ -153,12 +280,24 @@ std::optional<Token> Lexer::lexKeyword() noexcept
         advance();
 
     auto text = source.substr(start, current - start);
-    if (auto it = keywords.find(text); it != keywords.end())
-        return Token(it->second, line);
+    if (auto kw = lookupKeyword(text))
+        return makeToken(*kw);
 
     return {};
 }
 
+void Lexer::skipTo(const char* target) noexcept
+{
+    const char* pos = cursor();
+    while ((pos = scan->find(pos, target, '\n')) != target)
+    {
+        ++pos;
+        ++line;
+        locations.addLineStart(pos - source.data());
+    }
+    current = target - source.data();
+}
+
 bool Lexer::match(char expected) noexcept
 {
     if (isAtEnd())
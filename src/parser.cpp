@@ -19,34 +19,133 @@
 
 std::optional<ASTContext> Parser::parse()
 {
-    MUST_SUCCEED(sequence(true));
+    MUST_SUCCEED(sequence());
+    if (lexError)
+        return {};
     if (!isAtEnd())
     {
         error(peek(), "end of file expected.");
         return {};
     }
+    context.setLocations(lexer ? lexer->takeLocations() : tokens.getLocations());
     return std::move(context);
 }
 
-std::optional<const Sequence*> Parser::sequence(bool root)
+// Parses the whole program with an explicit stack of the loops and branches
+// that are not closed yet, so the native stack usage does not depend on how
+// deeply the program is nested.
+std::optional<const Sequence*> Parser::sequence()
 {
-    if (root && !check(TokenType::INIT))
+    if (!check(TokenType::INIT))
     {
         error(peek(), "'init' expected at the beginning of the program.");
         return {};
     }
 
-    std::vector<Node> commands;
-    do
+    // The commands of the enclosing sequences are below the ones of the
+    // innermost open block, they are copied into the arena once their
+    // sequence is complete.
+    Finally popCommands{[this] { commandStack.clear(); openBlocks.clear(); }};
+    enum class Step { Command, Separator, EndOfSequence };
+    Step step = Step::Command;
+    while (true)
     {
-        BIND(com, command());
-        commands.push_back(com);
-    } while (match(TokenType::SEMICOLON));
+        switch (step)
+        {
+        case Step::Command:
+        {
+            if (match(TokenType::ITER))
+            {
+                Token kw = previous();
+                MUST_SUCCEED(consume(TokenType::LEFT_BRACE));
+                if (match(TokenType::RIGHT_BRACE))
+                {
+                    error(kw, "the body of 'iter' must not be empty.");
+                    return {};
+                }
+                openBlocks.push_back({OpenBlock::LoopBody, kw, commandStack.size()});
+                break;
+            }
+            if (match(TokenType::LEFT_BRACE))
+            {
+                openBlocks.push_back({OpenBlock::BranchLhs, previous(), commandStack.size()});
+                // Exception to allow empty sequence in alternatives.
+                if (check(TokenType::RIGHT_BRACE))
+                    step = Step::EndOfSequence;
+                break;
+            }
+            BIND(com, command());
+            commandStack.push_back(com);
+            step = Step::Separator;
+            break;
+        }
+        case Step::Separator:
+            step = match(TokenType::SEMICOLON) ? Step::Command : Step::EndOfSequence;
+            break;
+        case Step::EndOfSequence:
+        {
+            const std::size_t first = openBlocks.empty() ? 0 : openBlocks.back().firstCommand;
+            const auto* seq = context.makeSequence(std::span(commandStack).subspan(first));
+            commandStack.resize(first);
+            if (openBlocks.empty())
+                return seq;
+
+            BIND(node, closeBlock(seq));
+            if (node)
+            {
+                commandStack.push_back(*node);
+                step = Step::Separator;
+            }
+            else
+            {
+                // The left alternative of a branch is closed, the right one
+                // starts.
+                step = check(TokenType::RIGHT_BRACE) ? Step::EndOfSequence : Step::Command;
+            }
+            break;
+        }
+        }
+    }
+}
 
-    const auto* seq = context.make<Sequence>(std::move(commands));
-    return seq;
+std::optional<std::optional<Node>> Parser::closeBlock(const Sequence* seq)
+{
+    OpenBlock& block = openBlocks.back();
+    MUST_SUCCEED(consume(TokenType::RIGHT_BRACE));
+    switch (block.kind)
+    {
+    case OpenBlock::LoopBody:
+    {
+        Node loop = context.make<Loop>(context.addToken(block.kw), seq);
+        openBlocks.pop_back();
+        return std::optional<Node>(loop);
+    }
+    case OpenBlock::BranchLhs:
+    {
+        BIND(kw, consume(TokenType::OR));
+        MUST_SUCCEED(consume(TokenType::LEFT_BRACE));
+        block = {OpenBlock::BranchRhs, kw, commandStack.size(), seq};
+        return std::optional<Node>();
+    }
+    case OpenBlock::BranchRhs:
+    {
+        const Sequence* lhs = block.lhs;
+        assert(lhs && seq);
+        if (lhs->nodes.empty() && seq->nodes.empty())
+        {
+            error(block.kw, "at most one alternative can be empty.");
+            return {};
+        }
+        Node branch = context.make<Branch>(context.addToken(block.kw), lhs, seq);
+        openBlocks.pop_back();
+        return std::optional<Node>(branch);
+    }
+    }
+    assert(false && "Unhandled block kind");
+    return {};
 }
 
+// Parses the commands that cannot contain other commands.
 std::optional<Node> Parser::command()
 {
     if (match(TokenType::INIT))
@@ -73,7 +172,8 @@ std::optional<Node> Parser::command()
             return {};
         }
 
-        return context.make<Init>(kw, topX, topY, width, height);
+        return context.make<Init>(context.addToken(kw), *topX.value, *topY.value,
+                                  *width.value, *height.value);
     }
     if (match(TokenType::TRANSLATION))
     {
@@ -84,7 +184,7 @@ std::optional<Node> Parser::command()
         BIND(y, consume(TokenType::NUMBER, "a number expected."));
         MUST_SUCCEED(consume(TokenType::RIGHT_PAREN));
 
-        return context.make<Translation>(kw, x, y);
+        return context.make<Translation>(context.addToken(kw), *x.value, *y.value);
     }
     if (match(TokenType::ROTATION))
     {
@@ -97,76 +197,38 @@ std::optional<Node> Parser::command()
         BIND(deg, consume(TokenType::NUMBER, "a number expected."));
         MUST_SUCCEED(consume(TokenType::RIGHT_PAREN));
 
-        return context.make<Rotation>(kw, x, y, deg);
+        return context.make<Rotation>(context.addToken(kw), *x.value, *y.value, *deg.value);
     }
-    if (match(TokenType::ITER))
-        return loop();
-    if (match(TokenType::LEFT_BRACE))
-        return branch();
-
     if (isAtEnd() || check(TokenType::RIGHT_BRACE))
         error(peek(), "redundant semicolon?");
 
     return {};
 }
 
-std::optional<const Branch*> Parser::branch()
+void Parser::pull() noexcept
 {
-    // Exception to allow empty sequence in alternatives.
-    const Sequence* lhs = nullptr;
-    if (check(TokenType::RIGHT_BRACE))
-        lhs = context.make<Sequence>(std::vector<Node>{});
-    else
+    std::optional<Token> next = [this]() -> std::optional<Token> {
+        if (lexer)
+            return lexer->next();
+        if (tokens.empty())
+            return std::nullopt;
+        // The last token is END_OF_FILE, keep returning it.
+        return tokens[std::min<TokenId>(nextToken++, tokens.size() - 1)];
+    }();
+
+    if (!next)
     {
-        BIND(lhs_candidate, sequence());
-        lhs = lhs_candidate;
+        // Pretend the input ended, so the parsing stops.
+        lexError = true;
+        next = Token(TokenType::END_OF_FILE, previous().line, previous().offset);
     }
-
-    MUST_SUCCEED(consume(TokenType::RIGHT_BRACE));
-    BIND(kw, consume(TokenType::OR));
-    MUST_SUCCEED(consume(TokenType::LEFT_BRACE));
-
-    const Sequence* rhs = nullptr;
-    if (check(TokenType::RIGHT_BRACE))
-        rhs = context.make<Sequence>(std::vector<Node>{});
-    else
-    {
-        BIND(rhs_candidate, sequence());
-        rhs = rhs_candidate;
-    }
-
-    MUST_SUCCEED(consume(TokenType::RIGHT_BRACE));
-
-    assert(lhs && rhs);
-    if (lhs->nodes.empty() && rhs->nodes.empty())
-    {
-        error(kw, "at most one alternative can be empty.");
-        return {};
-    }
-
-    return context.make<Branch>(kw, lhs, rhs);
-}
-
-std::optional<const Loop*> Parser::loop()
-{
-    Token kw = previous();
-    MUST_SUCCEED(consume(TokenType::LEFT_BRACE));
-
-    if (match(TokenType::RIGHT_BRACE))
-    {
-        error(kw, "the body of 'iter' must not be empty.");
-        return {};
-    }
-
-    BIND(body, sequence());
-    MUST_SUCCEED(consume(TokenType::RIGHT_BRACE));
-
-    return context.make<Loop>(kw, body);
+    lookahead[current % LookaheadSize] = *next;
 }
 
-
 void Parser::error(Token t, std::string_view message) const noexcept
 {
+    if (lexError)
+        return;
     if (t.type == TokenType::END_OF_FILE)
         diag.report(t.line, "at end of file", message);
     else
@@ -79,15 +79,14 @@ void renderRandomPath(cairo_t *cr, const Walk& w, RGB color, bool dotsOnly)
         for (unsigned i = 1; i < w.size(); ++i)
         {
             cairo_new_path(cr);
-            if (const auto* r = std::get_if<const Rotation*>(&w[i].op))
+            if (auto rotation = w[i].op.getIf<RotationOp>())
             {
-                const auto* rotation = *r;
-                int xdiff = *rotation->x.value - w[i].pos.x;
-                int ydiff = *rotation->y.value - w[i].pos.y;
+                int xdiff = rotation->x - w[i].pos.x;
+                int ydiff = rotation->y - w[i].pos.y;
                 double dist = sqrt(xdiff * xdiff + ydiff * ydiff);
                 double degPrev = atan2(-w[i-1].pos.y, w[i-1].pos.x);
                 double degCur = atan2(-w[i].pos.y, w[i].pos.x);
-                cairo_arc(cr, *rotation->x.value, -*rotation->y.value, dist, degCur, degPrev);
+                cairo_arc(cr, rotation->x, -rotation->y, dist, degCur, degPrev);
             }
             else
             {
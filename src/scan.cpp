@@ -0,0 +1,205 @@
+#include "include/scan.h"
+
+#include <bit>
+#include <cassert>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define HAVE_X86_SIMD
+#endif
+
+namespace
+{
+const char* skipWhitespaceScalar(const char* begin, const char* end) noexcept
+{
+    while (begin != end && isWhitespace(*begin))
+        ++begin;
+    return begin;
+}
+
+const char* skipDigitsScalar(const char* begin, const char* end) noexcept
+{
+    while (begin != end && isDigit(*begin))
+        ++begin;
+    return begin;
+}
+
+const char* findScalar(const char* begin, const char* end, char c) noexcept
+{
+    const void* found = std::memchr(begin, c, end - begin);
+    return found ? static_cast<const char*>(found) : end;
+}
+
+#ifdef HAVE_X86_SIMD
+// The vectorized kernels process the input in blocks and fall back to the
+// scalar versions for the tail, so they never read past the end.
+// The masks have a bit set for every byte that should be skipped.
+
+__attribute__((target("sse2")))
+unsigned whitespaceMask(__m128i block) noexcept
+{
+    __m128i ws = _mm_or_si128(
+        _mm_or_si128(_mm_cmpeq_epi8(block, _mm_set1_epi8(' ')), _mm_cmpeq_epi8(block, _mm_set1_epi8('\n'))),
+        _mm_or_si128(_mm_cmpeq_epi8(block, _mm_set1_epi8('\t')), _mm_cmpeq_epi8(block, _mm_set1_epi8('\r'))));
+    return static_cast<unsigned>(_mm_movemask_epi8(ws));
+}
+
+__attribute__((target("sse2")))
+unsigned digitMask(__m128i block) noexcept
+{
+    __m128i digits = _mm_and_si128(_mm_cmpgt_epi8(block, _mm_set1_epi8('0' - 1)),
+                                   _mm_cmplt_epi8(block, _mm_set1_epi8('9' + 1)));
+    return static_cast<unsigned>(_mm_movemask_epi8(digits));
+}
+
+__attribute__((target("sse2")))
+const char* skipWhitespaceSSE2(const char* begin, const char* end) noexcept
+{
+    for (; end - begin >= 16; begin += 16)
+    {
+        __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(begin));
+        unsigned skipped = whitespaceMask(block);
+        if (skipped != 0xFFFF)
+            return begin + std::countr_one(skipped);
+    }
+    return skipWhitespaceScalar(begin, end);
+}
+
+__attribute__((target("sse2")))
+const char* skipDigitsSSE2(const char* begin, const char* end) noexcept
+{
+    for (; end - begin >= 16; begin += 16)
+    {
+        __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(begin));
+        unsigned skipped = digitMask(block);
+        if (skipped != 0xFFFF)
+            return begin + std::countr_one(skipped);
+    }
+    return skipDigitsScalar(begin, end);
+}
+
+__attribute__((target("sse2")))
+const char* findSSE2(const char* begin, const char* end, char c) noexcept
+{
+    const __m128i needle = _mm_set1_epi8(c);
+    for (; end - begin >= 16; begin += 16)
+    {
+        __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(begin));
+        auto found = static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(block, needle)));
+        if (found)
+            return begin + std::countr_zero(found);
+    }
+    return findScalar(begin, end, c);
+}
+
+__attribute__((target("avx2")))
+const char* skipWhitespaceAVX2(const char* begin, const char* end) noexcept
+{
+    for (; end - begin >= 32; begin += 32)
+    {
+        __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(begin));
+        __m256i ws = _mm256_or_si256(
+            _mm256_or_si256(_mm256_cmpeq_epi8(block, _mm256_set1_epi8(' ')),
+                            _mm256_cmpeq_epi8(block, _mm256_set1_epi8('\n'))),
+            _mm256_or_si256(_mm256_cmpeq_epi8(block, _mm256_set1_epi8('\t')),
+                            _mm256_cmpeq_epi8(block, _mm256_set1_epi8('\r'))));
+        auto skipped = static_cast<unsigned>(_mm256_movemask_epi8(ws));
+        if (skipped != 0xFFFFFFFF)
+            return begin + std::countr_one(skipped);
+    }
+    return skipWhitespaceSSE2(begin, end);
+}
+
+__attribute__((target("avx2")))
+const char* skipDigitsAVX2(const char* begin, const char* end) noexcept
+{
+    for (; end - begin >= 32; begin += 32)
+    {
+        __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(begin));
+        __m256i digits = _mm256_and_si256(_mm256_cmpgt_epi8(block, _mm256_set1_epi8('0' - 1)),
+                                          _mm256_cmpgt_epi8(_mm256_set1_epi8('9' + 1), block));
+        auto skipped = static_cast<unsigned>(_mm256_movemask_epi8(digits));
+        if (skipped != 0xFFFFFFFF)
+            return begin + std::countr_one(skipped);
+    }
+    return skipDigitsSSE2(begin, end);
+}
+
+__attribute__((target("avx2")))
+const char* findAVX2(const char* begin, const char* end, char c) noexcept
+{
+    const __m256i needle = _mm256_set1_epi8(c);
+    for (; end - begin >= 32; begin += 32)
+    {
+        __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(begin));
+        auto found = static_cast<unsigned>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(block, needle)));
+        if (found)
+            return begin + std::countr_zero(found);
+    }
+    return findSSE2(begin, end, c);
+}
+#endif // HAVE_X86_SIMD
+
+constexpr ScanKernels scalarKernels{skipWhitespaceScalar, skipDigitsScalar, findScalar};
+#ifdef HAVE_X86_SIMD
+constexpr ScanKernels sse2Kernels{skipWhitespaceSSE2, skipDigitsSSE2, findSSE2};
+constexpr ScanKernels avx2Kernels{skipWhitespaceAVX2, skipDigitsAVX2, findAVX2};
+#endif
+} // anonymous namespace
+
+bool isSupported(ScanIsa isa) noexcept
+{
+    switch (isa)
+    {
+    case ScanIsa::Scalar:
+        return true;
+#ifdef HAVE_X86_SIMD
+    case ScanIsa::SSE2:
+        return __builtin_cpu_supports("sse2");
+    case ScanIsa::AVX2:
+        return __builtin_cpu_supports("avx2");
+#else
+    case ScanIsa::SSE2:
+    case ScanIsa::AVX2:
+        return false;
+#endif
+    }
+    return false;
+}
+
+std::string_view toString(ScanIsa isa) noexcept
+{
+    switch (isa)
+    {
+    case ScanIsa::Scalar: return "scalar";
+    case ScanIsa::SSE2: return "sse2";
+    case ScanIsa::AVX2: return "avx2";
+    }
+    assert(false && "Unhandled instruction set");
+    return "";
+}
+
+const ScanKernels& getScanKernels(ScanIsa isa) noexcept
+{
+    assert(isSupported(isa));
+    switch (isa)
+    {
+#ifdef HAVE_X86_SIMD
+    case ScanIsa::SSE2: return sse2Kernels;
+    case ScanIsa::AVX2: return avx2Kernels;
+#endif
+    default: return scalarKernels;
+    }
+}
+
+const ScanKernels& getScanKernels() noexcept
+{
+    static const ScanKernels& best = [] () -> const ScanKernels& {
+        for (ScanIsa isa : {ScanIsa::AVX2, ScanIsa::SSE2})
+            if (isSupported(isa))
+                return getScanKernels(isa);
+        return scalarKernels;
+    }();
+    return best;
+}
@@ -2,6 +2,14 @@
 
 #include <fmt/format.h>
 
+#include <fstream>
+#include <sstream>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
 
 void DiagnosticEmitter::error(int line, std::string_view message) const noexcept
 {
@@ -11,4 +19,61 @@ void DiagnosticEmitter::error(int line, std::string_view message) const noexcept
 void DiagnosticEmitter::report(int line, std::string_view where, std::string_view message) const noexcept
 {
     err << fmt::format("[line {}] Error {}: {}\n", line, where, message);
-}
\ No newline at end of file
+}
+
+std::optional<SourceFile> SourceFile::open(std::string_view path, bool allowMmap) noexcept
+{
+    std::string pathStr(path);
+    SourceFile result;
+    if (allowMmap)
+    {
+        int fd = ::open(pathStr.c_str(), O_RDONLY);
+        if (fd < 0)
+            return {};
+        Finally closeFile{[fd] { ::close(fd); }};
+
+        struct stat st{};
+        if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode))
+        {
+            // Mapping an empty file is an error, but there is nothing to copy either.
+            if (st.st_size == 0)
+                return result;
+
+            const auto size = static_cast<std::size_t>(st.st_size);
+            void* addr = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (addr != MAP_FAILED)
+            {
+                // The lexer reads the input front to back exactly once.
+                madvise(addr, size, MADV_SEQUENTIAL);
+                result.mapped = addr;
+                result.mappedSize = size;
+                result.view = std::string_view(static_cast<const char*>(addr), size);
+                return result;
+            }
+        }
+    }
+
+    std::ifstream file(pathStr);
+    if (!file)
+        return {};
+    std::stringstream fileContent;
+    fileContent << file.rdbuf();
+    result.buffer = std::move(fileContent).str();
+    result.view = result.buffer;
+    return result;
+}
+
+SourceFile::SourceFile(SourceFile&& other) noexcept
+    : mapped(other.mapped), mappedSize(other.mappedSize), buffer(std::move(other.buffer))
+{
+    view = mapped ? other.view : std::string_view(buffer);
+    other.mapped = nullptr;
+    other.mappedSize = 0;
+    other.view = {};
+}
+
+SourceFile::~SourceFile()
+{
+    if (mapped)
+        munmap(mapped, mappedSize);
+}
@@ -0,0 +1,130 @@
+#include <gtest/gtest.h>
+
+#include <filesystem>
+
+#include "include/analyze.h"
+#include "include/cache.h"
+#include "include/cfg_export.h"
+#include "include/parser.h"
+
+namespace
+{
+
+std::optional<CachedProgram> parseToFlat(std::string_view str, std::ostream& output)
+{
+    DiagnosticEmitter emitter(output, output);
+    Lexer lexer(std::string(str), emitter, "test.tr");
+    Parser parser(lexer, emitter);
+    auto ctxt = parser.parse();
+    if (!ctxt)
+        return {};
+    auto ast = FlatAST::flatten(std::move(*ctxt));
+    auto cfg = CFG::createCfg(ast);
+    return CachedProgram{std::move(ast), std::move(cfg)};
+}
+
+bool isInImage(std::string_view image, const void* p)
+{
+    auto bytes = static_cast<const char*>(p);
+    return std::less_equal<>{}(image.data(), bytes) && std::less<>{}(bytes, image.data() + image.size());
+}
+
+constexpr std::string_view source =
+R"(init(50, 50, 50, 50);
+translation(10, 0);
+iter {
+  {
+    translation(10, 0)
+  } or {
+    rotation(0, 0, -90)
+  }
+};
+{
+  translation(0, 1)
+} or {
+})";
+
+TEST(Cache, RoundTrip)
+{
+    std::stringstream output;
+    auto program = parseToFlat(source, output);
+    ASSERT_TRUE(program.has_value());
+    std::string image = ProgramCache::serialize(program->ast, program->cfg);
+    auto loaded = ProgramCache::deserialize(image);
+    ASSERT_TRUE(loaded.has_value());
+
+    EXPECT_EQ(print(loaded->ast), print(program->ast));
+    EXPECT_EQ(loaded->ast.getNodeCount(), program->ast.getNodeCount());
+    EXPECT_EQ(print(loaded->cfg), print(program->cfg));
+    EXPECT_EQ(loaded->ast.getLocation(loaded->ast.getLoops()[0].kw).line, 3);
+    EXPECT_EQ(loaded->ast.getLocation(loaded->ast.getLoops()[0].kw).file, "test.tr");
+
+    // The operations in the loaded CFG are the nodes of the loaded AST, so
+    // the analysis results can annotate it.
+    auto expected = getAnalysisResults("interval", program->cfg);
+    auto actual = getAnalysisResults("interval", loaded->cfg);
+    ASSERT_TRUE(expected && actual);
+    EXPECT_EQ(print(loaded->ast, actual->annotations), print(program->ast, expected->annotations));
+
+    // Serializing the loaded program gives back the same image.
+    EXPECT_EQ(ProgramCache::serialize(loaded->ast, loaded->cfg), image);
+
+    // The loaded program views the arrays in the image, the DFS tree is
+    // not computed again.
+    EXPECT_TRUE(isInImage(image, loaded->ast.getInits().data()));
+    EXPECT_TRUE(isInImage(image, loaded->ast.getLoops().data()));
+    EXPECT_TRUE(isInImage(image, loaded->cfg.blocks()[0].operations().data()));
+    EXPECT_TRUE(isInImage(image, loaded->cfg.dfsTree().rpoBlocks().data()));
+    EXPECT_TRUE(std::ranges::equal(loaded->cfg.dfsTree().rpoBlocks(), program->cfg.dfsTree().rpoBlocks()));
+}
+
+TEST(Cache, LoadKeepsTheFile)
+{
+    std::stringstream output;
+    auto program = parseToFlat(source, output);
+    ASSERT_TRUE(program.has_value());
+    auto path = std::filesystem::temp_directory_path() / "unittest_cache.dcache";
+    ASSERT_TRUE(ProgramCache::write(path.string(), program->ast, program->cfg));
+    auto loaded = ProgramCache::load(path.string());
+    std::filesystem::remove(path);
+    ASSERT_TRUE(loaded.has_value());
+    ASSERT_TRUE(loaded->file.has_value());
+    EXPECT_TRUE(isInImage(loaded->file->content(), loaded->ast.getInits().data()));
+    EXPECT_EQ(print(loaded->ast), print(program->ast));
+    EXPECT_EQ(print(loaded->cfg), print(program->cfg));
+}
+
+TEST(Cache, RejectsMalformedImages)
+{
+    std::stringstream output;
+    auto program = parseToFlat(source, output);
+    ASSERT_TRUE(program.has_value());
+    const std::string image = ProgramCache::serialize(program->ast, program->cfg);
+
+    EXPECT_FALSE(ProgramCache::deserialize(""));
+    EXPECT_FALSE(ProgramCache::deserialize(source));
+
+    // Every truncation is detected.
+    for (std::size_t size = 0; size < image.size(); ++size)
+        EXPECT_FALSE(ProgramCache::deserialize(std::string_view(image).substr(0, size))) << size;
+    EXPECT_FALSE(ProgramCache::deserialize(image + '\0'));
+
+    std::string wrongVersion = image;
+    wrongVersion[sizeof(std::uint32_t)] ^= 1;
+    EXPECT_FALSE(ProgramCache::deserialize(wrongVersion));
+
+    // Corrupt the payload word by word. The image is either rejected or
+    // still a well-formed program.
+    for (std::size_t pos = 2 * sizeof(std::uint32_t); pos < image.size(); pos += sizeof(std::uint32_t))
+    {
+        std::string corrupted = image;
+        corrupted[pos + 3] ^= 0x7f;
+        if (auto loaded = ProgramCache::deserialize(corrupted))
+        {
+            print(loaded->ast);
+            print(loaded->cfg);
+        }
+    }
+}
+
+} // anonymous
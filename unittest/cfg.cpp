@@ -1,7 +1,13 @@
 #include <gtest/gtest.h>
 
+#include <cstring>
+
 #include "include/parser.h"
+#include "include/block_mapping.h"
 #include "include/cfg.h"
+#include "include/cfg_export.h"
+#include "include/scc.h"
+#include "include/wto.h"
 
 namespace
 {
@@ -66,6 +72,70 @@ R"(digraph CFG {
     EXPECT_EQ(prettyPrintedCfg, expected);
 }
 
+TEST(Cfg, JsonExport)
+{
+    std::stringstream output;
+    auto result = parseToCFG("init(50, 50, 50, 50); iter { translation(-10, 0) }; rotation(0, 0, 90)", output);
+    ASSERT_TRUE(result);
+    std::string_view expected =
+R"json({"blocks": [
+  {"id": 0, "operations": ["init(50, 50, 50, 50)"], "successors": [1]},
+  {"id": 1, "operations": ["translation(-10, 0)"], "successors": [1, 2]},
+  {"id": 2, "operations": ["rotation(0, 0, 90)"], "successors": []}
+]}
+)json";
+    std::stringstream json;
+    {
+        BufferedWriter writer(json);
+        exportCfg(result->cfg, CfgFormat::Json, writer);
+    }
+    EXPECT_EQ(json.str(), expected);
+}
+
+TEST(Cfg, EdgeListExport)
+{
+    std::stringstream output;
+    auto result = parseToCFG("init(50, 50, 50, 50); iter { translation(-10, 0) }; rotation(0, 0, 90)", output);
+    ASSERT_TRUE(result);
+    std::stringstream edges;
+    {
+        BufferedWriter writer(edges);
+        exportCfg(ReverseCFG(result->cfg), CfgFormat::EdgeList, writer);
+    }
+    std::string bytes = edges.str();
+    ASSERT_EQ(bytes.size() % sizeof(std::uint32_t), 0u);
+    std::vector<std::uint32_t> words(bytes.size() / sizeof(std::uint32_t));
+    std::memcpy(words.data(), bytes.data(), bytes.size());
+    std::vector<std::uint32_t> expected{EdgeListMagic, EdgeListVersion, 3, 3,
+                                        0, 1, 1, 2, 1, 1};
+    EXPECT_EQ(words, expected);
+}
+
+TEST(Cfg, OperationImmediates)
+{
+    std::stringstream output;
+    auto result = parseToCFG("init(1, 2, 3, 4); translation(-5, 6); rotation(7, 8, 90)", output);
+    ASSERT_TRUE(result);
+    auto ops = result->cfg.blocks().front().operations();
+    ASSERT_EQ(ops.size(), 3u);
+
+    auto init = ops[0].getIf<InitOp>();
+    ASSERT_TRUE(init);
+    EXPECT_EQ(std::tuple(init->topX, init->topY, init->width, init->height), std::tuple(1, 2, 3, 4));
+    auto translation = ops[1].getIf<TranslationOp>();
+    ASSERT_TRUE(translation);
+    EXPECT_EQ(std::tuple(translation->x, translation->y), std::tuple(-5, 6));
+    EXPECT_FALSE(ops[1].getIf<RotationOp>());
+    auto rotation = ops[2].getIf<RotationOp>();
+    ASSERT_TRUE(rotation);
+    EXPECT_EQ(std::tuple(rotation->x, rotation->y, rotation->deg), std::tuple(7, 8, 90));
+
+    // The nodes are kept for the annotations.
+    const Sequence* root = result->context.getRoot();
+    for (std::size_t i = 0; i < ops.size(); ++i)
+        EXPECT_EQ(toNode(ops[i]), root->nodes[i]);
+}
+
 TEST(Cfg, BasicReverseCfg)
 {
     std::stringstream output;
@@ -169,6 +239,284 @@ R"(digraph CFG {
     EXPECT_EQ(prettyPrintedCfg, expected);
 }
 
+TEST(Cfg, SimplifiedCfg)
+{
+    std::stringstream output;
+    std::string_view source =
+R"(init(50, 50, 50, 50);
+translation(10, 0);
+iter {
+  iter {
+    translation(10, 0)
+  };
+  {
+    translation(10, 0)
+  } or {
+    {
+      translation(10, 0)
+    } or {
+      iter {
+        rotation(0, 0, 90)
+      }
+    }
+  }
+})";
+    std::string_view expected =
+R"(digraph CFG {
+  Node_0[label="init(50, 50, 50, 50)\ntranslation(10, 0)\n"]
+  Node_1[label="translation(10, 0)\n"]
+  Node_2[label="translation(10, 0)\n"]
+  Node_3[label="translation(10, 0)\n"]
+  Node_4[label="rotation(0, 0, 90)\n"]
+  Node_5[label=""]
+  Node_6[label=""]
+
+  Node_0 -> Node_1
+  Node_1 -> Node_1
+  Node_1 -> Node_2
+  Node_1 -> Node_3
+  Node_1 -> Node_4
+  Node_2 -> Node_5
+  Node_3 -> Node_5
+  Node_4 -> Node_4
+  Node_4 -> Node_5
+  Node_5 -> Node_1
+  Node_5 -> Node_6
+}
+)";
+    auto result = parseToCFG(source, output);
+    EXPECT_TRUE(output.str().empty());
+    ASSERT_TRUE(result.has_value());
+    auto simplified = result->cfg.simplify();
+    EXPECT_EQ(print(simplified.cfg), expected);
+
+    // The original CFG is in the test CfgWithMoreNesting.
+    std::vector<std::pair<int, int>> expectedLocations = {
+        {0, 2}, {1, 0}, {1, 1}, {1, 1}, {2, 1}, {1, 1}, {3, 1},
+        {1, 1}, {4, 1}, {4, 1}, {5, 0}, {5, 0}, {6, 0}
+    };
+    ASSERT_EQ(simplified.originalBlocks.size(), expectedLocations.size());
+    for (std::size_t i = 0; i < expectedLocations.size(); ++i)
+    {
+        EXPECT_EQ(simplified.originalBlocks[i].block, expectedLocations[i].first);
+        EXPECT_EQ(simplified.originalBlocks[i].operations, expectedLocations[i].second);
+    }
+}
+
+TEST(Cfg, WeakTopologicalOrder)
+{
+    std::stringstream output;
+    std::string_view source =
+R"(init(50, 50, 50, 50);
+translation(10, 0);
+iter {
+  iter {
+    translation(10, 0)
+  };
+  {
+    translation(10, 0)
+  } or {
+    {
+      translation(10, 0)
+    } or {
+      iter {
+        rotation(0, 0, 90)
+      }
+    }
+  }
+})";
+    auto result = parseToCFG(source, output);
+    EXPECT_TRUE(output.str().empty());
+    ASSERT_TRUE(result.has_value());
+    // The CFG is in the test CfgWithMoreNesting.
+    EXPECT_EQ(WeakTopologicalOrder(result->cfg).toString(), "0 (1 (2) 3 5 7 (8) 9 6 10 4 11) 12");
+    EXPECT_EQ(WeakTopologicalOrder(ReverseCFG(result->cfg)).toString(), "0 (1 2 3 (4) 5 6 7 8 9 (10) 11) 12");
+}
+
+TEST(Cfg, LoopForest)
+{
+    std::stringstream output;
+    std::string_view source =
+R"(init(50, 50, 50, 50);
+translation(10, 0);
+iter {
+  iter {
+    translation(10, 0)
+  };
+  {
+    translation(10, 0)
+  } or {
+    {
+      translation(10, 0)
+    } or {
+      iter {
+        rotation(0, 0, 90)
+      }
+    }
+  }
+})";
+    auto result = parseToCFG(source, output);
+    EXPECT_TRUE(output.str().empty());
+    ASSERT_TRUE(result.has_value());
+    // The CFG is in the test CfgWithMoreNesting.
+    const LoopForest& loops = result->cfg.loops();
+    std::vector<int> headers(loops.headers().begin(), loops.headers().end());
+    EXPECT_EQ(headers, (std::vector<int>{1, 2, 8}));
+    EXPECT_FALSE(loops.isIrreducible(1));
+    EXPECT_EQ(loops.parent(2), 1);
+    EXPECT_EQ(loops.parent(8), 1);
+    EXPECT_EQ(loops.parent(1), -1);
+    EXPECT_EQ(loops.loopOf(2), 2);
+    EXPECT_EQ(loops.loopOf(7), 1);
+    EXPECT_EQ(loops.loopOf(12), -1);
+    EXPECT_EQ(loops.depth(0), 0);
+    EXPECT_EQ(loops.depth(4), 1);
+    EXPECT_EQ(loops.depth(8), 2);
+    for (int header : loops.headers())
+        EXPECT_TRUE(result->cfg.dominators().dominates(header, header));
+    EXPECT_TRUE(result->cfg.dominators().dominates(1, 11));
+    EXPECT_TRUE(result->cfg.postDominators().dominates(11, 3));
+
+    // Every loop of the reverse CFG is a loop of the CFG.
+    ReverseCFG reverse(result->cfg);
+    EXPECT_EQ(reverse.loops().headers().size(), 3u);
+}
+
+TEST(Cfg, StronglyConnectedComponents)
+{
+    std::stringstream output;
+    std::string_view source =
+R"(init(50, 50, 50, 50);
+iter {
+  translation(10, 0)
+};
+{
+  translation(10, 0)
+} or {
+  iter {
+    rotation(0, 0, 90)
+  }
+};
+iter {
+  iter {
+    translation(10, 0)
+  };
+  translation(10, 0)
+};
+translation(10, 0))";
+    auto result = parseToCFG(source, output);
+    EXPECT_TRUE(output.str().empty());
+    ASSERT_TRUE(result.has_value());
+    StronglyConnectedComponents sccs(result->cfg);
+    EXPECT_EQ(sccs.toString(), "0 (1) 2 4 (5) 6 3 7 (8 9 10) 11");
+    EXPECT_EQ(StronglyConnectedComponents(ReverseCFG(result->cfg)).toString(), "0 (1 2 3) 4 5 (6) 7 8 9 (10) 11");
+    for (std::size_t component = 0; component < sccs.size(); ++component)
+    {
+        for (int block : sccs.blocks(component))
+        {
+            EXPECT_EQ(sccs.componentOf(block), static_cast<int>(component));
+            EXPECT_EQ(sccs.blocks(component)[sccs.positionInComponent(block)], block);
+            // The edges between the components only go forward.
+            for (int succ : result->cfg.blocks()[block].successors())
+                EXPECT_GE(sccs.componentOf(succ), static_cast<int>(component));
+        }
+    }
+}
+
+TEST(Cfg, BlockMapping)
+{
+    std::stringstream output;
+    std::string_view source =
+R"(init(50, 50, 50, 50);
+iter {
+  translation(10, 0)
+};
+translation(10, 0);
+{
+  translation(10, 0)
+} or {
+  rotation(0, 0, 90)
+};
+rotation(0, 0, 90))";
+    std::string_view edited =
+R"(init(50, 50, 50, 50);
+iter {
+  translation(10, 0)
+};
+translation(20, 0);
+iter {
+  translation(10, 0)
+};
+{
+  translation(10, 0)
+} or {
+  rotation(0, 0, 90)
+};
+rotation(0, 0, 90))";
+    auto before = parseToCFG(source, output);
+    auto after = parseToCFG(edited, output);
+    EXPECT_TRUE(output.str().empty());
+    ASSERT_TRUE(before.has_value());
+    ASSERT_TRUE(after.has_value());
+    BlockMapping mapping(before->cfg, after->cfg);
+    // The new blocks and the blocks after them.
+    EXPECT_EQ(std::vector<int>(mapping.changedBlocks().begin(), mapping.changedBlocks().end()),
+              (std::vector<int>{2, 3, 4, 5, 6}));
+    const int shift = static_cast<int>(after->cfg.blocks().size() - before->cfg.blocks().size());
+    for (int block = 0; block < static_cast<int>(after->cfg.blocks().size()); ++block)
+    {
+        if (mapping.previous(block) >= 0)
+        {
+            EXPECT_TRUE(mapping.previous(block) == block || mapping.previous(block) == block - shift);
+        }
+    }
+
+    // The reversed mapping compares the successors, reversing it again gives
+    // back the original mapping.
+    BlockMapping reversed = mapping.reversed();
+    // The new blocks and the blocks before them.
+    EXPECT_EQ(std::vector<int>(reversed.changedBlocks().begin(), reversed.changedBlocks().end()),
+              (std::vector<int>{3, 4, 5, 6}));
+    BlockMapping original = reversed.reversed();
+    for (int block = 0; block < static_cast<int>(after->cfg.blocks().size()); ++block)
+        EXPECT_EQ(original.previous(block), mapping.previous(block));
+
+    BlockMapping identity(before->cfg, before->cfg);
+    EXPECT_TRUE(identity.changedBlocks().empty());
+}
+
+TEST(Cfg, BitsetRpoWorklist)
+{
+    std::stringstream output;
+    // Spans several words of the bitset.
+    std::string source = "init(50, 50, 50, 50)";
+    for (int i = 0; i < 20; ++i)
+        source += ";\niter {\n  {\n    translation(10, 0)\n  } or {\n    rotation(0, 0, 90)\n  }\n}";
+    auto result = parseToCFG(source, output);
+    EXPECT_TRUE(output.str().empty());
+    ASSERT_TRUE(result.has_value());
+    ASSERT_GT(result->cfg.blocks().size(), 64u);
+
+    // Simulates a solver where every block changes twice.
+    RPOWorklist heap(result->cfg);
+    BitsetRPOWorklist bitset(result->cfg);
+    std::vector<int> visits(result->cfg.blocks().size(), 0);
+    heap.enqueue(0);
+    bitset.enqueue(0);
+    while (!heap.empty())
+    {
+        ASSERT_FALSE(bitset.empty());
+        int block = heap.dequeue();
+        EXPECT_EQ(bitset.dequeue(), block);
+        if (visits[block]++ < 2)
+        {
+            heap.enqueueSuccessors(block);
+            bitset.enqueueSuccessors(block);
+        }
+    }
+    EXPECT_TRUE(bitset.empty());
+}
+
 } // anonymous
 
 class CFGTest
@@ -178,6 +526,7 @@ public:
     static CFG createTestForRpoOrderMirrored();
     static CFG createTestForRpoRpoOrder_WithBackEdges();
     static CFG createTestForRpoRpoOrder_WithBackEdges_2();
+    static CFG createTestForUnreachableBlocks();
 };
 
 CFG CFGTest::createTestForRpoOrder()
@@ -189,14 +538,14 @@ CFG CFGTest::createTestForRpoOrder()
     //   |   3
     //    \ / 
     //     4
-    CFG cfg;
-    cfg.basicBlocks.resize(5);
+    CFG::Builder cfg;
+    cfg.blocks.resize(5);
     cfg.addEdge(0, 1)
        .addEdge(0, 2)
        .addEdge(1, 4)
        .addEdge(2, 3)
        .addEdge(3, 4);
-    return cfg;
+    return cfg.freeze();
 }
 
 TEST(Cfg, RpoOrder)
@@ -211,6 +560,41 @@ TEST(Cfg, RpoOrder)
     EXPECT_EQ(compare.getRpoPosition(4), 4);
 }
 
+TEST(Cfg, Dominators)
+{
+    CFG cfg = CFGTest::createTestForRpoOrder();
+    const DominatorTree& dominators = cfg.dominators();
+    EXPECT_EQ(dominators.idom(0), -1);
+    EXPECT_EQ(dominators.idom(1), 0);
+    EXPECT_EQ(dominators.idom(2), 0);
+    EXPECT_EQ(dominators.idom(3), 2);
+    EXPECT_EQ(dominators.idom(4), 0);
+    EXPECT_TRUE(dominators.dominates(0, 3));
+    EXPECT_TRUE(dominators.dominates(2, 3));
+    EXPECT_TRUE(dominators.dominates(3, 3));
+    EXPECT_FALSE(dominators.dominates(1, 4));
+    EXPECT_FALSE(dominators.dominates(3, 2));
+    std::vector<int> children(dominators.children(0).begin(), dominators.children(0).end());
+    EXPECT_EQ(children, (std::vector<int>{1, 2, 4}));
+    // Cached.
+    EXPECT_EQ(&dominators, &cfg.dominators());
+
+    const DominatorTree& postDominators = cfg.postDominators();
+    EXPECT_EQ(postDominators.idom(4), -1);
+    EXPECT_EQ(postDominators.idom(0), 4);
+    EXPECT_EQ(postDominators.idom(1), 4);
+    EXPECT_EQ(postDominators.idom(2), 3);
+    EXPECT_EQ(postDominators.idom(3), 4);
+    EXPECT_TRUE(postDominators.dominates(3, 2));
+    EXPECT_FALSE(postDominators.dominates(3, 0));
+
+    // The ReverseCFG numbers block i of the CFG as 4 - i.
+    ReverseCFG reverse(cfg);
+    EXPECT_EQ(reverse.dominators().idom(2), 1);
+    EXPECT_EQ(reverse.postDominators().idom(1), 2);
+    EXPECT_TRUE(reverse.postDominators().dominates(4, 0));
+}
+
 CFG CFGTest::createTestForRpoOrderMirrored()
 {
     //     0
@@ -220,14 +604,14 @@ CFG CFGTest::createTestForRpoOrderMirrored()
     //   3   |
     //    \ / 
     //     4
-    CFG cfg;
-    cfg.basicBlocks.resize(5);
+    CFG::Builder cfg;
+    cfg.blocks.resize(5);
     cfg.addEdge(0, 2)
        .addEdge(0, 1)
        .addEdge(1, 4)
        .addEdge(2, 3)
        .addEdge(3, 4);
-    return cfg;
+    return cfg.freeze();
 }
 
 TEST(Cfg, RpoOrder_Mirrored)
@@ -251,8 +635,8 @@ CFG CFGTest::createTestForRpoRpoOrder_WithBackEdges()
     //    |   3----|
     //     \ / 
     //      4
-    CFG cfg;
-    cfg.basicBlocks.resize(5);
+    CFG::Builder cfg;
+    cfg.blocks.resize(5);
     cfg.addEdge(0, 1)
        .addEdge(0, 2)
        .addEdge(1, 4)
@@ -260,7 +644,7 @@ CFG CFGTest::createTestForRpoRpoOrder_WithBackEdges()
        .addEdge(2, 0)
        .addEdge(3, 4)
        .addEdge(3, 0);
-    return cfg;
+    return cfg.freeze();
 }
 
 TEST(Cfg, RpoOrder_WithBackEdges)
@@ -274,6 +658,68 @@ TEST(Cfg, RpoOrder_WithBackEdges)
     EXPECT_EQ(compare.getRpoPosition(4), 4);
 }
 
+TEST(Cfg, DfsTree_WithBackEdges)
+{
+    CFG cfg = CFGTest::createTestForRpoRpoOrder_WithBackEdges();
+    const DfsTree& dfs = cfg.dfsTree();
+    EXPECT_EQ(dfs.parent(0), -1);
+    EXPECT_EQ(dfs.parent(1), 0);
+    EXPECT_EQ(dfs.parent(2), 0);
+    EXPECT_EQ(dfs.parent(3), 2);
+    EXPECT_EQ(dfs.parent(4), 3);
+    std::vector<int> rpo(dfs.rpoBlocks().begin(), dfs.rpoBlocks().end());
+    EXPECT_EQ(rpo, (std::vector<int>{0, 1, 2, 3, 4}));
+    std::vector<std::pair<int, int>> backEdges(dfs.backEdges().begin(), dfs.backEdges().end());
+    EXPECT_EQ(backEdges, (std::vector<std::pair<int, int>>{{2, 0}, {3, 0}}));
+    EXPECT_TRUE(dfs.isBackEdge(2, 0));
+    EXPECT_FALSE(dfs.isBackEdge(0, 2));
+    EXPECT_FALSE(dfs.isBackEdge(1, 4));
+    EXPECT_TRUE(dfs.isLoopHeader(0));
+    EXPECT_FALSE(dfs.isLoopHeader(4));
+
+    // The reverse CFG has its own DFS tree.
+    ReverseCFG reverse(cfg);
+    std::vector<std::pair<int, int>> reverseBackEdges(reverse.dfsTree().backEdges().begin(),
+                                                      reverse.dfsTree().backEdges().end());
+    EXPECT_EQ(reverseBackEdges, (std::vector<std::pair<int, int>>{{4, 2}, {4, 1}}));
+    EXPECT_TRUE(reverse.dfsTree().isLoopHeader(1));
+    EXPECT_TRUE(reverse.dfsTree().isLoopHeader(2));
+    EXPECT_FALSE(reverse.dfsTree().isLoopHeader(0));
+}
+
+CFG CFGTest::createTestForUnreachableBlocks()
+{
+    // 0   1 <-   4
+    // |   |  |
+    // 2   3---
+    CFG::Builder cfg;
+    cfg.blocks.resize(5);
+    cfg.addEdge(0, 2)
+       .addEdge(1, 3)
+       .addEdge(3, 1);
+    return cfg.freeze();
+}
+
+TEST(Cfg, DfsTree_UnreachableBlocks)
+{
+    CFG cfg = CFGTest::createTestForUnreachableBlocks();
+    const DfsTree& dfs = cfg.dfsTree();
+    std::vector<int> rpo(dfs.rpoBlocks().begin(), dfs.rpoBlocks().end());
+    EXPECT_EQ(rpo, (std::vector<int>{0, 2}));
+    EXPECT_TRUE(dfs.isReachable(2));
+    EXPECT_FALSE(dfs.isReachable(1));
+    EXPECT_EQ(dfs.rpoPosition(0), 0);
+    EXPECT_EQ(dfs.rpoPosition(2), 1);
+    EXPECT_EQ(dfs.rpoPosition(1), 2);
+    EXPECT_EQ(dfs.rpoPosition(3), 3);
+    EXPECT_EQ(dfs.rpoPosition(4), 4);
+    EXPECT_TRUE(dfs.backEdges().empty());
+
+    RPOCompare compare(cfg);
+    EXPECT_TRUE(compare(1, 2));
+    EXPECT_FALSE(compare(2, 1));
+}
+
 CFG CFGTest::createTestForRpoRpoOrder_WithBackEdges_2()
 {
     //      0  <----
@@ -283,8 +729,8 @@ CFG CFGTest::createTestForRpoRpoOrder_WithBackEdges_2()
     // |  |   3----|
     // |   \ / 
     // |----4
-    CFG cfg;
-    cfg.basicBlocks.resize(5);
+    CFG::Builder cfg;
+    cfg.blocks.resize(5);
     cfg.addEdge(0, 1)
        .addEdge(0, 2)
        .addEdge(1, 4)
@@ -293,7 +739,7 @@ CFG CFGTest::createTestForRpoRpoOrder_WithBackEdges_2()
        .addEdge(3, 4)
        .addEdge(3, 0)
        .addEdge(4, 1);
-    return cfg;
+    return cfg.freeze();
 }
 
 TEST(Cfg, RpoOrder_WithBackEdges_2)
@@ -313,6 +759,44 @@ TEST(Cfg, RpoOrder_WithBackEdges_2)
     EXPECT_EQ(compare.getRpoPosition(1), 4);
 }
 
+TEST(Cfg, WeakTopologicalOrder_WithBackEdges_2)
+{
+    CFG cfg = CFGTest::createTestForRpoRpoOrder_WithBackEdges_2();
+    WeakTopologicalOrder wto(cfg);
+    EXPECT_EQ(wto.toString(), "(0 2 3) (1 4)");
+    EXPECT_TRUE(wto.isHead(0));
+    EXPECT_EQ(wto.componentEnd(0), 3u);
+    EXPECT_FALSE(wto.isHead(1));
+    EXPECT_TRUE(wto.isHead(3));
+    EXPECT_EQ(wto.componentEnd(3), 5u);
+}
+
+TEST(Cfg, LoopForest_Irreducible)
+{
+    // The DFS visits 0, 2, 3, 4, 1, the loop of 4 is entered through 1 too.
+    CFG cfg = CFGTest::createTestForRpoRpoOrder_WithBackEdges_2();
+    const LoopForest& loops = cfg.loops();
+    std::vector<int> headers(loops.headers().begin(), loops.headers().end());
+    EXPECT_EQ(headers, (std::vector<int>{0, 4}));
+    EXPECT_FALSE(loops.isIrreducible(0));
+    EXPECT_TRUE(loops.isIrreducible(4));
+    EXPECT_EQ(loops.loopOf(2), 0);
+    EXPECT_EQ(loops.loopOf(3), 0);
+    EXPECT_EQ(loops.loopOf(1), 4);
+    EXPECT_EQ(loops.parent(4), -1);
+    EXPECT_EQ(loops.depth(1), 1);
+}
+
+TEST(Cfg, StronglyConnectedComponents_WithBackEdges_2)
+{
+    CFG cfg = CFGTest::createTestForRpoRpoOrder_WithBackEdges_2();
+    StronglyConnectedComponents sccs(cfg);
+    EXPECT_EQ(sccs.toString(), "(0 2 3) (4 1)");
+    EXPECT_EQ(sccs.componentOf(1), 1);
+    EXPECT_EQ(sccs.positionInComponent(1), 1u);
+    EXPECT_TRUE(sccs.isCyclic(1));
+}
+
 // TODO: add property based tests,
 //  * No unreachable nodes
 //  * All next indices are valid
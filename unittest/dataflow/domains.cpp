@@ -170,4 +170,64 @@ TEST(Domains, PowersetDomain)
     EXPECT_EQ(bottom.toString(), "{}");
 }
 
+TEST(Domains, InPlaceJoinAndWiden)
+{
+    using StringSetDomain = PowersetDomain<std::string>;
+    using Vec2Interval = Vec2Domain<IntervalDomain>;
+    static_assert(InPlaceJoinDomain<StringSetDomain>);
+    static_assert(InPlaceJoinDomain<SignDomain>);
+    static_assert(InPlaceWidenDomain<Vec2Interval>);
+
+    StringSetDomain set{"a"};
+    EXPECT_TRUE(set.joinWith(StringSetDomain{"b"}));
+    EXPECT_EQ(set, (StringSetDomain{"a", "b"}));
+    EXPECT_FALSE(set.joinWith(StringSetDomain{"b"}));
+    EXPECT_FALSE(set.joinWith(StringSetDomain::bottom()));
+
+    SignDomain sign{Positive};
+    EXPECT_FALSE(sign.joinWith(SignDomain{Bottom}));
+    EXPECT_TRUE(sign.joinWith(SignDomain{Negative}));
+    EXPECT_EQ(sign, SignDomain{Top});
+
+    Vec2Interval point{IntervalDomain{5}, IntervalDomain{5}};
+    EXPECT_FALSE(point.joinWith(point));
+    EXPECT_TRUE(point.joinWith(Vec2Interval{IntervalDomain{5}, IntervalDomain{7}}));
+    EXPECT_EQ(point, (Vec2Interval{IntervalDomain{5}, IntervalDomain{5, 7}}));
+    EXPECT_FALSE(point.widenWith(Vec2Interval{IntervalDomain{5}, IntervalDomain{6}}));
+    EXPECT_TRUE(point.widenWith(Vec2Interval{IntervalDomain{4, 5}, IntervalDomain{6}}));
+    EXPECT_EQ(point, (Vec2Interval{IntervalDomain{NEG_INF, 5}, IntervalDomain{5, 7}}));
+
+    IntervalDomain interval = IntervalDomain::bottom();
+    EXPECT_TRUE(widenInto(interval, IntervalDomain{1, 2}));
+    EXPECT_FALSE(widenInto(interval, IntervalDomain{1}));
+}
+
+TEST(Domains, Narrowing)
+{
+    using Vec2Interval = Vec2Domain<IntervalDomain>;
+    static_assert(NarrowableDomain<IntervalDomain>);
+    static_assert(NarrowableDomain<Vec2Interval>);
+
+    IntervalDomain top = IntervalDomain::top();
+    IntervalDomain bottom = IntervalDomain::bottom();
+    IntervalDomain range{1, 5};
+    // Only the infinite bounds are refined.
+    EXPECT_EQ(top.narrow(range), range);
+    EXPECT_EQ((IntervalDomain{1, INF}).narrow(IntervalDomain{2, 7}), (IntervalDomain{1, 7}));
+    EXPECT_EQ((IntervalDomain{NEG_INF, 5}).narrow(IntervalDomain{2, 3}), (IntervalDomain{2, 5}));
+    EXPECT_EQ((IntervalDomain{0, 10}).narrow(range), (IntervalDomain{0, 10}));
+    EXPECT_EQ(range.narrow(range), range);
+    EXPECT_EQ(range.narrow(bottom), bottom);
+    EXPECT_EQ(bottom.narrow(bottom), bottom);
+
+    Vec2Interval state{IntervalDomain{NEG_INF, 100}, IntervalDomain{-100, INF}};
+    EXPECT_EQ(state.narrow(Vec2Interval{IntervalDomain{-10, 100}, IntervalDomain{-100, 10}}),
+              (Vec2Interval{IntervalDomain{-10, 100}, IntervalDomain{-100, 10}}));
+    EXPECT_EQ(state.narrow(Vec2Interval::bottom()), Vec2Interval::bottom());
+
+    EXPECT_FALSE(narrowInto(range, range));
+    EXPECT_TRUE(narrowInto(top, range));
+    EXPECT_EQ(top, range);
+}
+
 } // anonymous
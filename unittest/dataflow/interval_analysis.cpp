@@ -10,11 +10,26 @@ auto primitiveIntervalAnalyze = analyzeForTest<CFG, Vec2Interval,
                                               intervalAnalysisToOperationAnnotations,
                                               intervalAnalysisToCoveredArea>;
 
+auto wtoIntervalAnalyze = analyzeForTest<CFG, Vec2Interval,
+                                         getWtoIntervalAnalysis,
+                                         intervalAnalysisToOperationAnnotations,
+                                         intervalAnalysisToCoveredArea>;
+
+auto sccIntervalAnalyze = analyzeForTest<CFG, Vec2Interval,
+                                         getSccIntervalAnalysis,
+                                         intervalAnalysisToOperationAnnotations,
+                                         intervalAnalysisToCoveredArea>;
+
 auto intervalAnalyze = analyzeForTest<CFG, Vec2Interval,
                                       getIntervalAnalysis,
                                       intervalAnalysisToOperationAnnotations,
                                       intervalAnalysisToCoveredArea>;
 
+auto narrowedIntervalAnalyze = analyzeForTest<CFG, Vec2Interval,
+                                              getNarrowedIntervalAnalysis,
+                                              intervalAnalysisToOperationAnnotations,
+                                              intervalAnalysisToCoveredArea>;
+
 TEST(IntervalAnalysis, PrimitiveAnalysis)
 {
     std::stringstream output;
@@ -171,4 +186,129 @@ rotation(0, 0, 180) /* { x: [-inf, -50], y: [-inf, -50] } */)";
     EXPECT_EQ(expected, annotatedSource);
 }
 
+TEST(IntervalAnalysis, WtoNestedLoops)
+{
+    std::stringstream output;
+    std::string_view source =
+R"(init(50, 50, 50, 50);
+iter {
+  translation(10, 0);
+  iter {
+    {
+      translation(0, 10)
+    } or {
+      translation(0, -10)
+    }
+  }
+};
+rotation(0, 0, 180))";
+    std::string_view expected =
+R"(init(50, 50, 50, 50) /* { x: [50, 100], y: [50, 100] } */;
+iter {
+  translation(10, 0) /* { x: [60, inf], y: [-inf, inf] } */;
+  iter {
+    {
+      translation(0, 10) /* { x: [60, inf], y: [-inf, inf] } */
+    } or {
+      translation(0, -10) /* { x: [60, inf], y: [-inf, inf] } */
+    }
+  }
+};
+rotation(0, 0, 180) /* { x: [-inf, -60], y: [-inf, inf] } */)";
+    auto result = wtoIntervalAnalyze(source, output);
+    ASSERT_TRUE(result);
+    std::string annotatedSource = print(result->context.getRoot(), result->anns);
+    EXPECT_TRUE(output.str().empty());
+    EXPECT_EQ(expected, annotatedSource);
+    // Widening at every block gives the same result here.
+    auto widenEverywhere = intervalAnalyze(source, output);
+    ASSERT_TRUE(widenEverywhere);
+    EXPECT_EQ(annotatedSource, print(widenEverywhere->context.getRoot(), widenEverywhere->anns));
+}
+
+TEST(IntervalAnalysis, SccNestedLoops)
+{
+    std::stringstream output;
+    std::string_view source =
+R"(init(50, 50, 50, 50);
+iter {
+  translation(10, 0);
+  iter {
+    {
+      translation(0, 10)
+    } or {
+      translation(0, -10)
+    }
+  }
+};
+rotation(0, 0, 180))";
+    auto result = sccIntervalAnalyze(source, output);
+    ASSERT_TRUE(result);
+    EXPECT_TRUE(output.str().empty());
+    // Widening at the heads of the loops gives the same result as the WTO.
+    auto wto = wtoIntervalAnalyze(source, output);
+    ASSERT_TRUE(wto);
+    EXPECT_EQ(print(wto->context.getRoot(), wto->anns), print(result->context.getRoot(), result->anns));
+
+    // The operations before and after the loops are evaluated once.
+    std::string logged;
+    struct Logger {
+      void log(Operation op, const Vec2Interval&, const Vec2Interval&) {
+        logBuffer += print(toNode(op));
+        logBuffer += '\n';
+      }
+      std::string& logBuffer;
+    };
+    TransferTracer<Vec2Interval, IntervalTransfer, Logger> tracer{{}, Logger{logged}};
+    auto traced = solveMonotoneFrameworkWithScc<Vec2Interval, decltype(tracer)>(result->cfg, tracer);
+    EXPECT_EQ(traced, result->analysis);
+    auto occurrences = [&](std::string_view op) {
+        std::size_t count = 0;
+        for (auto pos = logged.find(op); pos != std::string::npos; pos = logged.find(op, pos + 1))
+            ++count;
+        return count;
+    };
+    EXPECT_EQ(occurrences("init("), 1u);
+    EXPECT_EQ(occurrences("rotation("), 1u);
+    EXPECT_GT(occurrences("translation(10, 0)"), 1u);
+}
+
+TEST(IntervalAnalysis, NarrowAfterWidening)
+{
+    std::stringstream output;
+    std::string_view source =
+R"(init(50, 50, 50, 50);
+iter {
+  rotation(0, 0, 180);
+  iter {
+    rotation(0, 0, 90);
+    init(0, 0, 10, 10)
+  }
+})";
+    // Widening at the inner loop loses the lower bound of x and the upper
+    // bound of y, the init at the end of the loop restores them.
+    std::string_view expected =
+R"(init(50, 50, 50, 50) /* { x: [50, 100], y: [50, 100] } */;
+iter {
+  rotation(0, 0, 180) /* { x: [-100, 0], y: [-100, 0] } */;
+  iter {
+    rotation(0, 0, 90) /* { x: [-10, 100], y: [-100, 10] } */;
+    init(0, 0, 10, 10) /* { x: [0, 10], y: [0, 10] } */
+  }
+})";
+    auto result = narrowedIntervalAnalyze(source, output);
+    ASSERT_TRUE(result);
+    EXPECT_TRUE(output.str().empty());
+    EXPECT_EQ(expected, print(result->context.getRoot(), result->anns));
+
+    auto widened = intervalAnalyze(source, output);
+    ASSERT_TRUE(widened);
+    // Narrowing never loses precision.
+    for (size_t block = 0; block < result->analysis.size(); ++block)
+    {
+        EXPECT_TRUE(result->analysis[block].x <= widened->analysis[block].x);
+        EXPECT_TRUE(result->analysis[block].y <= widened->analysis[block].y);
+    }
+}
+
 } // anonymous
\ No newline at end of file
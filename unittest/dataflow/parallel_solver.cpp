@@ -0,0 +1,68 @@
+#include <gtest/gtest.h>
+#include "analysis_test_support.h"
+#include "benchmark/bench_support.h"
+#include "include/dataflow/parallel_solver.h"
+#include "include/dataflow/analyses/interval_analysis.h"
+#include "include/dataflow/analyses/reachable_operations_analysis.h"
+#include "include/dataflow/analyses/sign_analysis.h"
+
+namespace
+{
+auto signAnalyze = analyzeForTest<CFG, Vec2Sign,
+                                 getSignAnalysis,
+                                 signAnalysisToOperationAnnotations,
+                                 signAnalysisToCoveredArea>;
+
+auto primitiveIntervalAnalyze = analyzeForTest<CFG, Vec2Interval,
+                                              getPrimitiveIntervalAnalysis,
+                                              intervalAnalysisToOperationAnnotations,
+                                              intervalAnalysisToCoveredArea>;
+
+TEST(ParallelSolver, SameResultsAsSequential)
+{
+    std::stringstream output;
+    auto result = signAnalyze(generateWideProgram(200, 3), output);
+    EXPECT_EQ(output.str(), "");
+    ASSERT_TRUE(result);
+    const CFG& cfg = result->cfg;
+    ReverseCFG reverse(cfg);
+    MaterializedReverseCFG materialized(cfg);
+
+    const auto& sign = result->analysis;
+    auto past = solveMonotoneFramework<StringSetDomain, ReachableOperationsTransfer>(cfg);
+    auto future = solveMonotoneFramework<StringSetDomain, ReachableOperationsTransfer>(reverse);
+    ASSERT_FALSE(sign.empty());
+    ASSERT_FALSE(past.empty());
+    ASSERT_FALSE(future.empty());
+    // Repeated to make the different interleavings more likely.
+    for (unsigned threads : {1u, 2u, 3u, 8u})
+    {
+        for (int run = 0; run < 5; ++run)
+        {
+            EXPECT_EQ((solveMonotoneFrameworkInParallel<Vec2Sign, SignTransfer>(cfg, threads)), sign);
+            EXPECT_EQ((solveMonotoneFrameworkInParallel<StringSetDomain, ReachableOperationsTransfer>(cfg, threads)),
+                      past);
+            EXPECT_EQ((solveMonotoneFrameworkInParallel<StringSetDomain, ReachableOperationsTransfer>(reverse, threads)),
+                      future);
+            EXPECT_EQ((solveMonotoneFrameworkInParallel<StringSetDomain, ReachableOperationsTransfer>(materialized,
+                                                                                                     threads)),
+                      future);
+        }
+    }
+}
+
+TEST(ParallelSolver, GivesUpWithoutConvergence)
+{
+    std::stringstream output;
+    std::string_view source =
+R"(init(50, 50, 50, 50);
+iter {
+  translation(10, 0)
+})";
+    auto result = primitiveIntervalAnalyze(source, output);
+    ASSERT_TRUE(result);
+    EXPECT_TRUE(result->analysis.empty());
+    EXPECT_TRUE((solveMonotoneFrameworkInParallel<Vec2Interval, IntervalTransfer>(result->cfg, 4)).empty());
+}
+
+} // anonymous
@@ -64,4 +64,129 @@ R"(/* {Init, Rotation, Translation} */ init(50, 50, 50, 50);
     EXPECT_EQ(expected, annotatedSource);
 }
 
+TEST(ReachableOpsAnalysis, FutureOperationsWithWto)
+{
+    std::stringstream output;
+    std::string_view source =
+R"(init(50, 50, 50, 50);
+iter {
+  translation(10, 0);
+  iter {
+    {
+      translation(10, 0)
+    } or {
+      rotation(0, 0, 90)
+    }
+  }
+};
+translation(10, 0))";
+    auto result = futureOpsAnalyze(source, output);
+    EXPECT_TRUE(output.str().empty());
+    ASSERT_TRUE(result);
+    ReverseCFG reverse(result->cfg);
+    auto wtoResults = solveMonotoneFrameworkWithWto<StringSetDomain, ReachableOperationsTransfer>(reverse);
+    EXPECT_EQ(wtoResults, result->analysis);
+}
+
+TEST(ReachableOpsAnalysis, FutureOperationsOnMaterializedReverseCfg)
+{
+    std::stringstream output;
+    std::string_view source =
+R"(init(50, 50, 50, 50);
+iter {
+  translation(10, 0);
+  {
+    iter {
+      rotation(0, 0, 90)
+    }
+  } or {
+    translation(10, 0)
+  }
+};
+rotation(0, 0, 90))";
+    auto result = futureOpsAnalyze(source, output);
+    EXPECT_TRUE(output.str().empty());
+    ASSERT_TRUE(result);
+    MaterializedReverseCFG reverse(result->cfg);
+    ASSERT_EQ(reverse.blocks().size(), result->cfg.blocks().size());
+    auto results = getFutureOperationsAnalysis(reverse);
+    EXPECT_EQ(results, result->analysis);
+    std::string annotatedSource = print(result->context.getRoot(),
+                                        futureOperationsAnalysisToOperationAnnotations(reverse, results));
+    EXPECT_EQ(print(result->context.getRoot(), result->anns), annotatedSource);
+}
+
+TEST(ReachableOpsAnalysis, FutureOperationsWithScc)
+{
+    std::stringstream output;
+    std::string_view source =
+R"(init(50, 50, 50, 50);
+iter {
+  translation(10, 0);
+  iter {
+    {
+      translation(10, 0)
+    } or {
+      rotation(0, 0, 90)
+    }
+  }
+};
+translation(10, 0))";
+    auto result = futureOpsAnalyze(source, output);
+    EXPECT_TRUE(output.str().empty());
+    ASSERT_TRUE(result);
+    ReverseCFG reverse(result->cfg);
+    auto sccResults = solveMonotoneFrameworkWithScc<StringSetDomain, ReachableOperationsTransfer>(reverse);
+    EXPECT_EQ(sccResults, result->analysis);
+    MaterializedReverseCFG materialized(result->cfg);
+    sccResults = solveMonotoneFrameworkWithScc<StringSetDomain, ReachableOperationsTransfer>(materialized);
+    EXPECT_EQ(sccResults, result->analysis);
+}
+
+TEST(ReachableOpsAnalysis, IncrementalAfterEdit)
+{
+    std::stringstream output;
+    std::string_view source =
+R"(init(50, 50, 50, 50);
+iter {
+  translation(10, 0)
+};
+{
+  translation(10, 0)
+} or {
+  rotation(0, 0, 90)
+};
+translation(10, 0))";
+    std::string_view edited =
+R"(init(50, 50, 50, 50);
+iter {
+  translation(10, 0)
+};
+{
+  rotation(0, 0, 90)
+} or {
+  iter {
+    rotation(0, 0, 90)
+  }
+};
+translation(10, 0))";
+    auto before = pastOpsAnalyze(source, output);
+    auto after = pastOpsAnalyze(edited, output);
+    ASSERT_TRUE(before);
+    ASSERT_TRUE(after);
+    BlockMapping mapping(before->cfg, after->cfg);
+    auto past = solveMonotoneFrameworkIncrementally<StringSetDomain, ReachableOperationsTransfer>(
+        after->cfg, mapping, before->analysis);
+    EXPECT_EQ(past, after->analysis);
+
+    auto futureBefore = futureOpsAnalyze(source, output);
+    auto futureAfter = futureOpsAnalyze(edited, output);
+    ASSERT_TRUE(futureBefore);
+    ASSERT_TRUE(futureAfter);
+    auto future = solveMonotoneFrameworkIncrementally<StringSetDomain, ReachableOperationsTransfer>(
+        ReverseCFG(futureAfter->cfg), mapping.reversed(), futureBefore->analysis);
+    EXPECT_EQ(future, futureAfter->analysis);
+    EXPECT_TRUE(output.str().empty());
+}
+
 } // anonymous namepsace
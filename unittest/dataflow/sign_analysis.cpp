@@ -114,4 +114,98 @@ iter {
     EXPECT_EQ(result->analysis[2], posPos);
 }
 
+TEST(SignAnalysis, SimplifiedCfg)
+{
+    std::stringstream output;
+    std::string_view source =
+R"(init(50, 50, 50, 50);
+iter {
+  {
+    translation(-10, 0)
+  } or {
+    {
+      iter {
+        rotation(0, 0, 90)
+      }
+    } or {
+      translation(0, 10)
+    }
+  }
+};
+translation(10, 0))";
+    auto result = signAnalyze(source, output);
+    EXPECT_TRUE(output.str().empty());
+    ASSERT_TRUE(result);
+    auto simplified = result->cfg.simplify();
+    EXPECT_LT(simplified.cfg.blocks().size(), result->cfg.blocks().size());
+    auto simplifiedResults = getSignAnalysis(simplified.cfg);
+    ASSERT_FALSE(simplifiedResults.empty());
+    auto originalResults = originalBlockResults<Vec2Sign, SignTransfer>(simplified, simplifiedResults);
+    ASSERT_EQ(originalResults.size(), result->analysis.size());
+    for (std::size_t i = 0; i < originalResults.size(); ++i)
+    {
+        // The removed empty blocks may be located at the start of a join.
+        if (!result->cfg.blocks()[i].operations().empty())
+        {
+            EXPECT_EQ(originalResults[i], result->analysis[i]);
+        }
+    }
+    auto anns = signAnalysisToOperationAnnotations(simplified.cfg, simplifiedResults);
+    EXPECT_EQ(print(result->context.getRoot(), anns), print(result->context.getRoot(), result->anns));
+}
+
+TEST(SignAnalysis, IncrementalAfterEdits)
+{
+    std::string_view source =
+R"(init(50, 50, 50, 50);
+translation(10, 0);
+iter {
+  { translation(10, 0) } or { rotation(0, 0, 90) }
+};
+translation(-100, 0);
+rotation(0, 0, 180))";
+    std::vector<std::string_view> edits = {
+R"(init(50, 50, 50, 50);
+translation(10, 0);
+iter {
+  { translation(10, 0) } or { rotation(0, 0, 90) }
+};
+translation(100, 0);
+rotation(0, 0, 180))",
+R"(init(50, 50, 50, 50);
+translation(-10, 0);
+iter {
+  { translation(10, 0) } or { rotation(0, 0, 90) }
+};
+translation(-100, 0);
+rotation(0, 0, 180))",
+R"(init(50, 50, 50, 50);
+translation(10, 0);
+iter {
+  { translation(10, 0) } or { rotation(0, 0, 90) }
+};
+translation(-100, 0);
+iter {
+  translation(0, -100)
+};
+rotation(0, 0, 180))",
+R"(init(50, 50, 50, 50);
+translation(10, 0);
+translation(-100, 0);
+rotation(0, 0, 180))"};
+    std::stringstream output;
+    auto before = signAnalyze(source, output);
+    ASSERT_TRUE(before);
+    for (auto edited : edits)
+    {
+        auto after = signAnalyze(edited, output);
+        ASSERT_TRUE(after);
+        BlockMapping mapping(before->cfg, after->cfg);
+        auto results = solveMonotoneFrameworkIncrementally<Vec2Sign, SignTransfer>(after->cfg, mapping,
+                                                                                  before->analysis);
+        EXPECT_EQ(results, after->analysis) << edited;
+    }
+    EXPECT_TRUE(output.str().empty());
+}
+
 } // namespace
@@ -11,6 +11,7 @@ struct ParseResult
 {
     Walk w;
     ASTContext ctxt; // Owns the nodes.
+    CFG cfg;
 };
 
 std::optional<ParseResult> getWalk(std::string_view str, std::ostream& output)
@@ -26,7 +27,7 @@ std::optional<ParseResult> getWalk(std::string_view str, std::ostream& output)
         return {};
     auto cfg = CFG::createCfg(ctxt->getRoot());
     auto w = createRandomWalk(cfg);
-    return ParseResult{std::move(w), std::move(*ctxt)};
+    return ParseResult{std::move(w), std::move(*ctxt), std::move(cfg)};
 }
 
 constexpr double threshold = 1e-10;
@@ -64,15 +65,15 @@ rotation(0, 0, 90))";
     EXPECT_TRUE(veryClose(result->w[0].pos, expected[0]));
     EXPECT_TRUE(veryClose(result->w[1].pos, expected[1]));
     EXPECT_TRUE(veryClose(result->w[2].pos, expected[2]));
-    EXPECT_TRUE(std::holds_alternative<const Init*>(result->w[0].op));
-    EXPECT_TRUE(std::holds_alternative<const Translation*>(result->w[1].op));
-    EXPECT_TRUE(std::holds_alternative<const Rotation*>(result->w[2].op));
+    EXPECT_TRUE(result->w[0].op.getKind() == Operation::Kind::Init);
+    EXPECT_TRUE(result->w[1].op.getKind() == Operation::Kind::Translation);
+    EXPECT_TRUE(result->w[2].op.getKind() == Operation::Kind::Rotation);
 
     std::string_view expectedSourceText =
 R"(init(50, 0, 0, 0) /* {{x: 50, y: 0}} */;
 translation(10, 0) /* {{x: 60, y: 0}} */;
 rotation(0, 0, 90) /* {{x: 0, y: 60}} */)";
-    Annotations annotations = annotateWithWalks(std::vector<Walk>{result->w});
+    Annotations annotations = annotateWithWalks(result->cfg, std::vector<Walk>{result->w});
     std::string annotated = print(result->ctxt.getRoot(), annotations);
     EXPECT_EQ(expectedSourceText, annotated);
 }
@@ -88,10 +89,10 @@ iter { translation(10, 0) })";
     EXPECT_TRUE(output.str().empty());
     EXPECT_TRUE(result);
     EXPECT_TRUE(!result->w.empty());
-    EXPECT_TRUE(std::holds_alternative<const Init*>(result->w[0].op));
+    EXPECT_TRUE(result->w[0].op.getKind() == Operation::Kind::Init);
     for (unsigned i = 1; i < result->w.size(); ++i)
     {
-        EXPECT_TRUE(std::holds_alternative<const Translation*>(result->w[i].op));
+        EXPECT_TRUE(result->w[i].op.getKind() == Operation::Kind::Translation);
         EXPECT_TRUE(veryClose(result->w[i - 1].pos.x + 10, result->w[i].pos.x));
     }
 }
@@ -107,8 +108,8 @@ R"(init(50, 0, 0, 0);
     EXPECT_TRUE(output.str().empty());
     EXPECT_TRUE(result);
     EXPECT_TRUE(result->w.size() == 2);
-    EXPECT_TRUE(std::holds_alternative<const Init*>(result->w[0].op));
-    EXPECT_TRUE(std::holds_alternative<const Translation*>(result->w[1].op));
+    EXPECT_TRUE(result->w[0].op.getKind() == Operation::Kind::Init);
+    EXPECT_TRUE(result->w[1].op.getKind() == Operation::Kind::Translation);
     EXPECT_TRUE(veryClose(distSquared(result->w[0].pos, result->w[1].pos), 10*10));
 }
 
@@ -1,15 +1,17 @@
 #include <gtest/gtest.h>
 
 #include <algorithm>
+#include <random>
 
 #include "include/lexer.h"
+#include "include/scan.h"
 #include "include/utils.h"
 
 namespace
 {
 using enum TokenType;
 
-std::vector<Token> lexString(std::string s, std::ostream& output)
+TokenBuffer lexString(std::string s, std::ostream& output)
 {
     DiagnosticEmitter emitter(output, output);
     Lexer lexer(std::move(s), emitter);
@@ -83,6 +85,47 @@ TEST(Lexer, TestMultiLineComments)
     EXPECT_TRUE(output.str().empty());
 }
 
+TEST(Lexer, TestSourceView)
+{
+    // Memory-mapped sources are not null terminated, the lexer must not
+    // look past the end of the view.
+    std::stringstream output;
+    DiagnosticEmitter emitter(output, output);
+    std::string_view source = "12 345";
+    Lexer lexer(source.substr(0, 4), emitter);
+    auto tokenList = lexer.lexAll();
+    TokenType tokenTypes[] = {NUMBER, NUMBER, END_OF_FILE};
+    EXPECT_TRUE(std::equal(tokenList.begin(), tokenList.end(), std::begin(tokenTypes), std::end(tokenTypes),
+                [](const Token& t, TokenType type) { return t.type == type; }));
+    EXPECT_EQ(*tokenList[0].value, 12);
+    EXPECT_EQ(*tokenList[1].value, 3);
+    EXPECT_TRUE(output.str().empty());
+}
+
+TEST(Lexer, TestLocations)
+{
+    std::stringstream output;
+    DiagnosticEmitter emitter(output, output);
+    Lexer lexer(std::string("init\n  iter // comment\n/* multi\n line */ or 5"), emitter, "test.tr");
+    auto tokenList = lexer.lexAll();
+    ASSERT_EQ(tokenList.size(), 5U);
+    EXPECT_TRUE(output.str().empty());
+
+    auto iterLoc = tokenList.location(1);
+    EXPECT_EQ(iterLoc.file, "test.tr");
+    EXPECT_EQ(iterLoc.line, 2U);
+    EXPECT_EQ(iterLoc.column, 3U);
+
+    auto orLoc = tokenList.location(2);
+    EXPECT_EQ(orLoc.line, 4U);
+    EXPECT_EQ(orLoc.column, 10U);
+    EXPECT_EQ(tokenList[2].line, 4U);
+
+    EXPECT_EQ(tokenList.type(3), NUMBER);
+    EXPECT_EQ(tokenList.value(3), 5);
+    EXPECT_EQ(tokenList.location(3).column, 13U);
+}
+
 TEST(Lexer, ErrorMessages)
 { 
     {
@@ -97,7 +140,57 @@ TEST(Lexer, ErrorMessages)
         EXPECT_TRUE(maybeTokens.empty());
         EXPECT_EQ("[line 1] Error : Expected number after '-'.\n", output.str());
     }
+    {
+        std::stringstream output;
+        auto maybeTokens = lexString("inits", output);
+        EXPECT_TRUE(maybeTokens.empty());
+        EXPECT_EQ("[line 1] Error : Unexpected token: 'inits'.\n", output.str());
+    }
+    {
+        std::stringstream output;
+        auto maybeTokens = lexString("-2147483648\n2147483648", output);
+        EXPECT_TRUE(maybeTokens.empty());
+        EXPECT_EQ("[line 2] Error : Number literal out of range: '2147483648'.\n", output.str());
+    }
+    {
+        std::stringstream output;
+        auto maybeTokens = lexString("0 /* never\n closed *", output);
+        EXPECT_TRUE(maybeTokens.empty());
+        EXPECT_EQ("[line 2] Error : Multiline comment not closed.\n", output.str());
+    }
 }
 
+TEST(Lexer, ScanKernels)
+{
+    // Every vectorized kernel must agree with the scalar one, including
+    // the blocks that straddle the end of the input.
+    std::mt19937 gen(0);
+    std::uniform_int_distribution<int> pickChar(0, 5);
+    constexpr char alphabet[] = {' ', '\n', '\t', '7', '*', 'x'};
+    const ScanKernels& reference = getScanKernels(ScanIsa::Scalar);
+    for (ScanIsa isa : {ScanIsa::SSE2, ScanIsa::AVX2})
+    {
+        if (!isSupported(isa))
+            continue;
+        const ScanKernels& kernels = getScanKernels(isa);
+        for (char runChar : {' ', '7', 'x'})
+        {
+            for (int length = 0; length < 100; ++length)
+            {
+                std::string input(length, runChar);
+                for (int i = 0; i < 10; ++i)
+                    input += alphabet[pickChar(gen)];
+                for (std::size_t size : {static_cast<std::size_t>(length), input.size()})
+                {
+                    const char* begin = input.data();
+                    const char* end = begin + size;
+                    EXPECT_EQ(kernels.skipWhitespace(begin, end), reference.skipWhitespace(begin, end)) << toString(isa);
+                    EXPECT_EQ(kernels.skipDigits(begin, end), reference.skipDigits(begin, end)) << toString(isa);
+                    EXPECT_EQ(kernels.find(begin, end, '*'), reference.find(begin, end, '*')) << toString(isa);
+                }
+            }
+        }
+    }
+}
 
 } // namespace
\ No newline at end of file
@@ -1,10 +1,31 @@
 #include <gtest/gtest.h>
 
+#include "include/cfg.h"
+#include "include/cfg_export.h"
+#include "include/flat_ast.h"
 #include "include/parser.h"
 
 namespace
 {
 
+// Loops and branches nested alternately `depth` deep, indented the way
+// print() does when `indent` is set.
+std::string nestedProgram(int depth, bool indent)
+{
+    std::string open;
+    std::string close;
+    auto indentation = [indent](int level) { return std::string(indent ? 2 * level : 0, ' '); };
+    for (int level = 0; level < depth; ++level)
+        open += indentation(level) + (level % 2 == 0 ? "iter {\n" : "{\n");
+    for (int level = depth - 1; level >= 0; --level)
+    {
+        close += "\n" + indentation(level) + "}";
+        if (level % 2 != 0)
+            close += " or {\n" + indentation(level + 1) + "rotation(0, 0, 90)\n" + indentation(level) + "}";
+    }
+    return "init(0, 0, 10, 10);\n" + open + indentation(depth) + "translation(1, 2)" + close;
+}
+
 std::optional<ASTContext> parseString(std::string_view str, std::ostream& output)
 {
     DiagnosticEmitter emitter(output, output);
@@ -128,6 +149,136 @@ TEST(Parser, RedundantSemicolon2)
     EXPECT_EQ(output.str(), "[line 1] Error at end of file: redundant semicolon?\n");
 }
 
+TEST(Parser, StreamingTokens)
+{
+    std::stringstream output;
+    std::string_view source =
+R"(init(50, 50, 50, 50);
+iter {
+  {
+    translation(10, 0)
+  } or {
+    rotation(0, 0, 90)
+  }
+})";
+    DiagnosticEmitter emitter(output, output);
+    Lexer lexer(source, emitter);
+    Parser parser(lexer, emitter);
+    auto result = parser.parse();
+    EXPECT_TRUE(output.str().empty());
+    EXPECT_TRUE(result.has_value());
+    EXPECT_EQ(print(result->getRoot()), source);
+}
+
+TEST(Parser, StreamingTokensLexError)
+{
+    std::stringstream output;
+    std::string_view source = "init(50, 50, 50, 50); translation(1 | 2)";
+    DiagnosticEmitter emitter(output, output);
+    Lexer lexer(source, emitter);
+    Parser parser(lexer, emitter);
+    auto result = parser.parse();
+    EXPECT_FALSE(result.has_value());
+    EXPECT_EQ(output.str(), "[line 1] Error : Unexpected token: '|'.\n");
+}
+
+TEST(Parser, FlatAST)
+{
+    std::stringstream output;
+    std::string_view source =
+R"(init(50, 50, 50, 50);
+iter {
+  {
+    translation(10, 0);
+    iter {
+      translation(10, 0)
+    }
+  } or {
+    rotation(0, 0, 90)
+  }
+})";
+    auto result = parseString(source, output);
+    ASSERT_TRUE(result.has_value());
+    auto nodeCount = result->getNodeCount();
+    auto ast = FlatAST::flatten(std::move(*result));
+    EXPECT_EQ(ast.getNodeCount(), nodeCount);
+    EXPECT_EQ(print(ast), source);
+
+    // The root is the first sequence, the rest are numbered in preorder.
+    EXPECT_EQ(ast.children(ast.getRootId()).size(), 2);
+    EXPECT_EQ(ast.getInits().size(), 1);
+    EXPECT_EQ(ast.getTranslations().size(), 2);
+    EXPECT_EQ(ast.getRotations().size(), 1);
+    EXPECT_EQ(ast.getSequences().size(), 5);
+    EXPECT_EQ(ast.getBranches().size(), 1);
+    EXPECT_EQ(ast.getLoops().size(), 2);
+    EXPECT_EQ(ast.getTranslations()[1].x, 10);
+    EXPECT_EQ(ast.getLocation(ast.getLoops()[0].kw).line, 2);
+
+    // The children are linked by index.
+    auto rootChildren = ast.children(ast.getRootId());
+    EXPECT_EQ(rootChildren[0], NodeId(NodeKind::Init, 0));
+    EXPECT_EQ(rootChildren[1], NodeId(NodeKind::Loop, 0));
+    NodeId outerBody = ast.body(rootChildren[1]);
+    EXPECT_EQ(outerBody, NodeId(NodeKind::Sequence, 1));
+    NodeId branch = ast.children(outerBody)[0];
+    EXPECT_EQ(ast.kind(branch), NodeKind::Branch);
+    EXPECT_EQ(ast.lhs(branch), NodeId(NodeKind::Sequence, 2));
+    EXPECT_EQ(ast.rhs(branch), NodeId(NodeKind::Sequence, 4));
+    EXPECT_EQ(ast.children(ast.rhs(branch))[0], NodeId(NodeKind::Rotation, 0));
+
+    for (NodeId id : {NodeId(NodeKind::Init, 0), NodeId(NodeKind::Translation, 1), NodeId(NodeKind::Rotation, 0)})
+        EXPECT_EQ(ast.getId(ast.getNode(id)), id);
+
+    // The CFG built from the flat AST has the same shape and its
+    // operations refer to the nodes of the flat arrays.
+    auto linked = parseString(source, output);
+    ASSERT_TRUE(linked.has_value());
+    auto cfg = CFG::createCfg(ast);
+    EXPECT_EQ(print(cfg), print(CFG::createCfg(linked->getRoot())));
+    const Operation op = cfg.blocks()[0].operations()[0];
+    ASSERT_TRUE(op.hasNodeId());
+    EXPECT_EQ(op.getNodeId(), NodeId(NodeKind::Init, 0));
+    EXPECT_EQ(cfg.getNode(op), Node(&ast.getInits()[0]));
+}
+
+TEST(Parser, DeepNesting)
+{
+    constexpr int depth = 1'000'000;
+    std::stringstream output;
+    std::string source = nestedProgram(depth, false);
+    DiagnosticEmitter emitter(output, output);
+    Lexer lexer(std::string_view(source), emitter);
+    Parser parser(lexer, emitter);
+    auto result = parser.parse();
+    EXPECT_TRUE(output.str().empty());
+    ASSERT_TRUE(result.has_value());
+
+    // Every level has a sequence, the branches have a second one with a
+    // rotation. Plus the root, init and translation.
+    const std::size_t loops = depth / 2;
+    const std::size_t branches = depth / 2;
+    EXPECT_EQ(result->getNodeCount(), 2 * depth + 2 * branches + 3);
+
+    auto cfg = CFG::createCfg(result->getRoot());
+    EXPECT_EQ(cfg.blocks().size(), 1 + 2 * loops + 3 * branches);
+
+    auto ast = FlatAST::flatten(std::move(*result));
+    EXPECT_EQ(ast.getLoops().size(), loops);
+    EXPECT_EQ(ast.getBranches().size(), branches);
+}
+
+TEST(Parser, DeepNestingPrinted)
+{
+    // The indentation makes the printed program quadratic in the depth.
+    std::stringstream output;
+    std::string source = nestedProgram(1000, true);
+    auto result = parseString(source, output);
+    EXPECT_TRUE(output.str().empty());
+    ASSERT_TRUE(result.has_value());
+    EXPECT_EQ(print(result->getRoot()), source);
+}
+
 TEST(Parser, FromFuzzing)
 {
     std::stringstream output;